@@ -0,0 +1,845 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSART_HPP
+#define CMPSART_HPP
+
+#include "cmpsptr.hpp"
+#include <string_view>
+#include <string>
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#endif
+
+namespace cmpsptr
+{
+    /*
+    Adaptive radix tree, whose inner nodes hold 4 (Node4), 16 (Node16), 48 (Node48) or 256 (Node256) children, growing and shrinking
+    between these layouts as keys are added or removed; all links are compressed pointers to nodes allocated from block pools, so they
+    never fall back to the pointer list and take only 4 bytes, allowing a Node16 to fit in two cache lines and a Node48 in eight.
+    Inner nodes store up to MAX_PREFIX bytes of their compressed path, longer prefixes being verified against the key held by the leaf
+    reached at the end of the search; a key ending at an inner node is kept by its leaf link, so keys can be prefixes of other keys.
+    */
+    template <typename V>
+    class CmpsArt
+    {
+    protected:
+        static constexpr uint32_t MAX_PREFIX = 8U;
+
+        enum NodeType : uint8_t
+        {
+            LEAF, NODE4, NODE16, NODE48, NODE256
+        };
+
+        struct Node
+        {
+            uint8_t type;
+        };
+
+        using Link = CmpsPtr<Node>;
+
+        struct Leaf : Node
+        {
+            V value;
+            std::string key;
+
+            inline Leaf(const std::string_view key, V&& value) : Node{LEAF}, value(std::move(value)), key(key) {}
+        };
+
+        struct Inner : Node
+        {
+            uint16_t count = 0U;
+            uint32_t prefixLen = 0U;
+            uint8_t prefix[MAX_PREFIX];
+            CmpsPtr<Leaf> leaf;
+
+            inline Inner(const NodeType type) : Node{type} {}
+        };
+
+        struct Node4 : Inner
+        {
+            uint8_t keys[4];
+            Link children[4];
+
+            inline Node4() : Inner(NODE4) {}
+        };
+
+        struct Node16 : Inner
+        {
+            uint8_t keys[16];
+            Link children[16];
+
+            inline Node16() : Inner(NODE16) {}
+        };
+
+        struct Node48 : Inner
+        {
+            uint8_t index[256] = {};
+            Link children[48];
+
+            inline Node48() : Inner(NODE48) {}
+        };
+
+        struct Node256 : Inner
+        {
+            Link children[256];
+
+            inline Node256() : Inner(NODE256) {}
+        };
+
+        Link _root;
+        std::size_t _size = 0U;
+
+        inline Node* root() const
+        {
+            return const_cast<Link&>(this->_root).ptr();
+        }
+
+        inline static Leaf* asLeaf(Node* const node)
+        {
+            return static_cast<Leaf*>(node);
+        }
+
+        inline static Inner* asInner(Node* const node)
+        {
+            return static_cast<Inner*>(node);
+        }
+
+        static void dropNode(Node* const node)
+        {
+            switch (node->type)
+            {
+            case LEAF:
+                CmpsPool<Leaf>::drop(asLeaf(node));
+                break;
+            case NODE4:
+                CmpsPool<Node4>::drop(static_cast<Node4*>(node));
+                break;
+            case NODE16:
+                CmpsPool<Node16>::drop(static_cast<Node16*>(node));
+                break;
+            case NODE48:
+                CmpsPool<Node48>::drop(static_cast<Node48*>(node));
+                break;
+            default:
+                CmpsPool<Node256>::drop(static_cast<Node256*>(node));
+            }
+        }
+
+        static Link* findChild(Inner* const node, const uint8_t byte)
+        {
+            switch (node->type)
+            {
+            case NODE4:
+            {
+                auto node4 = static_cast<Node4*>(node);
+                for (uint32_t i = 0U; i < node4->count; i += 1U)
+                {
+                    if (node4->keys[i] == byte)
+                    {
+                        return &node4->children[i];
+                    }
+                }
+                return nullptr;
+            }
+            case NODE16:
+            {
+                auto node16 = static_cast<Node16*>(node);
+    #if defined(__SSE2__) && defined(__GNUC__)
+                auto matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(node16->keys)));
+                const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches)) & ((1U << node16->count) - 1U);
+                return mask ? &node16->children[__builtin_ctz(mask)] : nullptr;
+    #else
+                for (uint32_t i = 0U; i < node16->count; i += 1U)
+                {
+                    if (node16->keys[i] == byte)
+                    {
+                        return &node16->children[i];
+                    }
+                }
+                return nullptr;
+    #endif
+            }
+            case NODE48:
+            {
+                auto node48 = static_cast<Node48*>(node);
+                const uint32_t slot = node48->index[byte];
+                return slot ? &node48->children[slot - 1U] : nullptr;
+            }
+            default:
+            {
+                auto child = &static_cast<Node256*>(node)->children[byte];
+                return child->hasRef() ? child : nullptr;
+            }
+            }
+        }
+
+        template <typename N>
+        inline static N* resize(Inner* const node)
+        {
+            auto resized = CmpsPool<N>::make();
+            resized->count = node->count;
+            resized->prefixLen = node->prefixLen;
+            std::memcpy(resized->prefix, node->prefix, MAX_PREFIX);
+            resized->leaf.setPtr(node->leaf.ptr());
+            return resized;
+        }
+
+        template <typename N>
+        static void insertSorted(N* const node, const uint8_t byte, Node* const child)
+        {
+            uint32_t pos = 0U;
+            const uint32_t count = node->count;
+            while (pos < count && node->keys[pos] < byte)
+            {
+                pos += 1U;
+            }
+            for (uint32_t i = count; i > pos; i -= 1U)
+            {
+                node->keys[i] = node->keys[i - 1U];
+                node->children[i].setPtr(node->children[i - 1U].ptr());
+            }
+            node->keys[pos] = byte;
+            node->children[pos].setPtr(child);
+            node->count = static_cast<uint16_t>(count + 1U);
+        }
+
+        static void addChild(Link& ref, Inner* node, const uint8_t byte, Node* const child)
+        {
+            switch (node->type)
+            {
+            case NODE4:
+            {
+                auto node4 = static_cast<Node4*>(node);
+                if (node4->count < 4U)
+                {
+                    insertSorted(node4, byte, child);
+                    return;
+                }
+                auto node16 = resize<Node16>(node4);
+                std::memcpy(node16->keys, node4->keys, 4U);
+                for (uint32_t i = 0U; i < 4U; i += 1U)
+                {
+                    node16->children[i].setPtr(node4->children[i].ptr());
+                }
+                CmpsPool<Node4>::drop(node4);
+                ref.setPtr(node16);
+                insertSorted(node16, byte, child);
+                return;
+            }
+            case NODE16:
+            {
+                auto node16 = static_cast<Node16*>(node);
+                if (node16->count < 16U)
+                {
+                    insertSorted(node16, byte, child);
+                    return;
+                }
+                auto node48 = resize<Node48>(node16);
+                for (uint32_t i = 0U; i < 16U; i += 1U)
+                {
+                    node48->children[i].setPtr(node16->children[i].ptr());
+                    node48->index[node16->keys[i]] = static_cast<uint8_t>(i + 1U);
+                }
+                CmpsPool<Node16>::drop(node16);
+                ref.setPtr(node48);
+                node = node48;
+            }
+            [[fallthrough]];
+            case NODE48:
+            {
+                auto node48 = static_cast<Node48*>(node);
+                if (node48->count < 48U)
+                {
+                    uint32_t slot = 0U;
+                    while (node48->children[slot].hasRef())
+                    {
+                        slot += 1U;
+                    }
+                    node48->children[slot].setPtr(child);
+                    node48->index[byte] = static_cast<uint8_t>(slot + 1U);
+                    node48->count += 1U;
+                    return;
+                }
+                auto node256 = resize<Node256>(node48);
+                for (uint32_t i = 0U; i < 256U; i += 1U)
+                {
+                    const uint32_t slot = node48->index[i];
+                    if (slot)
+                    {
+                        node256->children[i].setPtr(node48->children[slot - 1U].ptr());
+                    }
+                }
+                CmpsPool<Node48>::drop(node48);
+                ref.setPtr(node256);
+                node = node256;
+            }
+            [[fallthrough]];
+            default:
+            {
+                auto node256 = static_cast<Node256*>(node);
+                node256->children[byte].setPtr(child);
+                node256->count += 1U;
+            }
+            }
+        }
+
+        static void removeChild(Link& ref, Inner* const node, const uint8_t byte)
+        {
+            switch (node->type)
+            {
+            case NODE4:
+            case NODE16:
+            {
+                auto node4 = static_cast<Node4*>(node);
+                auto node16 = static_cast<Node16*>(node);
+                auto keys = node->type == NODE4 ? node4->keys : node16->keys;
+                auto children = node->type == NODE4 ? node4->children : node16->children;
+                const uint32_t count = node->count;
+                uint32_t pos = 0U;
+                while (keys[pos] != byte)
+                {
+                    pos += 1U;
+                }
+                for (uint32_t i = pos + 1U; i < count; i += 1U)
+                {
+                    keys[i - 1U] = keys[i];
+                    children[i - 1U].setPtr(children[i].ptr());
+                }
+                children[count - 1U].setPtr(nullptr);
+                node->count = static_cast<uint16_t>(count - 1U);
+                if (node->type == NODE16 && count - 1U < 4U)
+                {
+                    auto resized = resize<Node4>(node16);
+                    std::memcpy(resized->keys, node16->keys, count - 1U);
+                    for (uint32_t i = 0U; i < count - 1U; i += 1U)
+                    {
+                        resized->children[i].setPtr(node16->children[i].ptr());
+                    }
+                    CmpsPool<Node16>::drop(node16);
+                    ref.setPtr(resized);
+                }
+                break;
+            }
+            case NODE48:
+            {
+                auto node48 = static_cast<Node48*>(node);
+                node48->children[node48->index[byte] - 1U].setPtr(nullptr);
+                node48->index[byte] = 0U;
+                if ((node48->count -= 1U) < 13U)
+                {
+                    auto resized = resize<Node16>(node48);
+                    uint32_t pos = 0U;
+                    for (uint32_t i = 0U; i < 256U; i += 1U)
+                    {
+                        const uint32_t slot = node48->index[i];
+                        if (slot)
+                        {
+                            resized->keys[pos] = static_cast<uint8_t>(i);
+                            resized->children[pos++].setPtr(node48->children[slot - 1U].ptr());
+                        }
+                    }
+                    CmpsPool<Node48>::drop(node48);
+                    ref.setPtr(resized);
+                }
+                break;
+            }
+            default:
+            {
+                auto node256 = static_cast<Node256*>(node);
+                node256->children[byte].setPtr(nullptr);
+                if ((node256->count -= 1U) < 38U)
+                {
+                    auto resized = resize<Node48>(node256);
+                    uint32_t pos = 0U;
+                    for (uint32_t i = 0U; i < 256U; i += 1U)
+                    {
+                        if (node256->children[i].hasRef())
+                        {
+                            resized->children[pos].setPtr(node256->children[i].ptr());
+                            resized->index[i] = static_cast<uint8_t>(++pos);
+                        }
+                    }
+                    CmpsPool<Node256>::drop(node256);
+                    ref.setPtr(resized);
+                }
+            }
+            }
+        }
+
+        static Leaf* minimum(Node* node)
+        {
+            while (node->type != LEAF)
+            {
+                auto inner = asInner(node);
+                if (inner->leaf.hasRef())
+                {
+                    return inner->leaf.ptr();
+                }
+                switch (node->type)
+                {
+                case NODE4:
+                    node = static_cast<Node4*>(inner)->children[0].ptr();
+                    break;
+                case NODE16:
+                    node = static_cast<Node16*>(inner)->children[0].ptr();
+                    break;
+                case NODE48:
+                {
+                    auto node48 = static_cast<Node48*>(inner);
+                    uint32_t i = 0U;
+                    while (node48->index[i] == 0U)
+                    {
+                        i += 1U;
+                    }
+                    node = node48->children[node48->index[i] - 1U].ptr();
+                    break;
+                }
+                default:
+                {
+                    auto node256 = static_cast<Node256*>(inner);
+                    uint32_t i = 0U;
+                    while (!node256->children[i].hasRef())
+                    {
+                        i += 1U;
+                    }
+                    node = node256->children[i].ptr();
+                }
+                }
+            }
+            return asLeaf(node);
+        }
+
+        static uint32_t prefixMismatch(Inner* const node, const std::string_view key, const std::size_t depth)
+        {
+            const uint32_t prefixLen = node->prefixLen;
+            const std::size_t keyLen = key.size() - depth;
+            uint32_t maxLen = prefixLen < MAX_PREFIX ? prefixLen : MAX_PREFIX;
+            if (maxLen > keyLen)
+            {
+                maxLen = static_cast<uint32_t>(keyLen);
+            }
+            uint32_t i = 0U;
+            for (; i < maxLen; i += 1U)
+            {
+                if (node->prefix[i] != static_cast<uint8_t>(key[depth + i]))
+                {
+                    return i;
+                }
+            }
+            if (prefixLen > MAX_PREFIX && i == MAX_PREFIX)
+            {
+                auto& leafKey = minimum(node)->key;
+                maxLen = static_cast<uint32_t>((leafKey.size() < key.size() ? leafKey.size() : key.size()) - depth);
+                if (maxLen > prefixLen)
+                {
+                    maxLen = prefixLen;
+                }
+                for (; i < maxLen; i += 1U)
+                {
+                    if (leafKey[depth + i] != key[depth + i])
+                    {
+                        return i;
+                    }
+                }
+            }
+            return i;
+        }
+
+        static void place(Link& ref, Inner* const node, Leaf* const leaf, const std::size_t depth)
+        {
+            if (leaf->key.size() == depth)
+            {
+                node->leaf.setPtr(leaf);
+            }
+            else
+            {
+                addChild(ref, node, static_cast<uint8_t>(leaf->key[depth]), leaf);
+            }
+        }
+
+        bool insert(Link& ref, const std::string_view key, std::size_t depth, V& value)
+        {
+            auto node = ref.ptr();
+            if (node == nullptr)
+            {
+                ref.setPtr(CmpsPool<Leaf>::make(key, std::move(value)));
+                return true;
+            }
+            if (node->type == LEAF)
+            {
+                auto leaf = asLeaf(node);
+                if (leaf->key == key)
+                {
+                    leaf->value = std::move(value);
+                    return false;
+                }
+                auto& leafKey = leaf->key;
+                const std::size_t maxLen = leafKey.size() < key.size() ? leafKey.size() : key.size();
+                std::size_t common = depth;
+                while (common < maxLen && leafKey[common] == key[common])
+                {
+                    common += 1U;
+                }
+                auto split = CmpsPool<Node4>::make();
+                split->prefixLen = static_cast<uint32_t>(common - depth);
+                std::memcpy(split->prefix, key.data() + depth, split->prefixLen < MAX_PREFIX ? split->prefixLen : MAX_PREFIX);
+                Link splitRef;
+                splitRef.setPtr(split);
+                place(splitRef, split, leaf, common);
+                place(splitRef, split, CmpsPool<Leaf>::make(key, std::move(value)), common);
+                ref.setPtr(splitRef.ptr());
+                return true;
+            }
+            auto inner = asInner(node);
+            if (inner->prefixLen)
+            {
+                const uint32_t mismatch = prefixMismatch(inner, key, depth);
+                if (mismatch < inner->prefixLen)
+                {
+                    auto split = CmpsPool<Node4>::make();
+                    split->prefixLen = mismatch;
+                    std::memcpy(split->prefix, inner->prefix, mismatch < MAX_PREFIX ? mismatch : MAX_PREFIX);
+                    Link splitRef;
+                    splitRef.setPtr(split);
+                    if (inner->prefixLen <= MAX_PREFIX)
+                    {
+                        addChild(splitRef, split, inner->prefix[mismatch], inner);
+                        inner->prefixLen -= mismatch + 1U;
+                        std::memmove(inner->prefix, inner->prefix + mismatch + 1U, inner->prefixLen < MAX_PREFIX ? inner->prefixLen : MAX_PREFIX);
+                    }
+                    else
+                    {
+                        auto& leafKey = minimum(inner)->key;
+                        addChild(splitRef, split, static_cast<uint8_t>(leafKey[depth + mismatch]), inner);
+                        inner->prefixLen -= mismatch + 1U;
+                        std::memcpy(inner->prefix, leafKey.data() + depth + mismatch + 1U, inner->prefixLen < MAX_PREFIX ? inner->prefixLen : MAX_PREFIX);
+                    }
+                    place(splitRef, split, CmpsPool<Leaf>::make(key, std::move(value)), depth + mismatch);
+                    ref.setPtr(splitRef.ptr());
+                    return true;
+                }
+                depth += inner->prefixLen;
+            }
+            if (depth == key.size())
+            {
+                if (inner->leaf.hasRef())
+                {
+                    inner->leaf.ptr()->value = std::move(value);
+                    return false;
+                }
+                inner->leaf.setPtr(CmpsPool<Leaf>::make(key, std::move(value)));
+                return true;
+            }
+            auto child = findChild(inner, static_cast<uint8_t>(key[depth]));
+            if (child)
+            {
+                return this->insert(*child, key, depth + 1U, value);
+            }
+            addChild(ref, inner, static_cast<uint8_t>(key[depth]), CmpsPool<Leaf>::make(key, std::move(value)));
+            return true;
+        }
+
+        static void collapse(Link& ref, Inner* const inner)
+        {
+            if (inner->count == 0U)
+            {
+                ref.setPtr(inner->leaf.ptr());
+                dropNode(inner);
+            }
+            else if (inner->count == 1U && inner->type == NODE4 && !inner->leaf.hasRef())
+            {
+                auto node4 = static_cast<Node4*>(inner);
+                auto child = node4->children[0].ptr();
+                if (child->type != LEAF)
+                {
+                    auto childInner = asInner(child);
+                    uint8_t prefix[MAX_PREFIX];
+                    uint32_t prefixLen = inner->prefixLen < MAX_PREFIX ? inner->prefixLen : MAX_PREFIX;
+                    std::memcpy(prefix, inner->prefix, prefixLen);
+                    if (prefixLen < MAX_PREFIX)
+                    {
+                        prefix[prefixLen++] = node4->keys[0];
+                    }
+                    for (uint32_t i = 0U; prefixLen < MAX_PREFIX && i < childInner->prefixLen && i < MAX_PREFIX; i += 1U)
+                    {
+                        prefix[prefixLen++] = childInner->prefix[i];
+                    }
+                    std::memcpy(childInner->prefix, prefix, prefixLen);
+                    childInner->prefixLen += inner->prefixLen + 1U;
+                }
+                ref.setPtr(child);
+                dropNode(inner);
+            }
+        }
+
+        bool remove(Link& ref, const std::string_view key, std::size_t depth)
+        {
+            auto node = ref.ptr();
+            if (node == nullptr)
+            {
+                return false;
+            }
+            if (node->type == LEAF)
+            {
+                if (asLeaf(node)->key == key)
+                {
+                    dropNode(node);
+                    ref.setPtr(nullptr);
+                    return true;
+                }
+                return false;
+            }
+            auto inner = asInner(node);
+            if (inner->prefixLen)
+            {
+                if (prefixMismatch(inner, key, depth) < inner->prefixLen)
+                {
+                    return false;
+                }
+                depth += inner->prefixLen;
+            }
+            if (depth >= key.size())
+            {
+                auto leaf = inner->leaf.ptr();
+                if (leaf && leaf->key == key)
+                {
+                    inner->leaf.setPtr(nullptr);
+                    dropNode(leaf);
+                    collapse(ref, inner);
+                    return true;
+                }
+                return false;
+            }
+            const auto byte = static_cast<uint8_t>(key[depth]);
+            auto child = findChild(inner, byte);
+            if (child && this->remove(*child, key, depth + 1U))
+            {
+                if (!child->hasRef())
+                {
+                    removeChild(ref, inner, byte);
+                    collapse(ref, asInner(ref.ptr()));
+                }
+                return true;
+            }
+            return false;
+        }
+
+        template <typename F>
+        static void visit(Node* const node, F& fn)
+        {
+            if (node->type == LEAF)
+            {
+                auto leaf = asLeaf(node);
+                fn(std::string_view(leaf->key), leaf->value);
+                return;
+            }
+            auto inner = asInner(node);
+            if (inner->leaf.hasRef())
+            {
+                visit(inner->leaf.ptr(), fn);
+            }
+            switch (node->type)
+            {
+            case NODE4:
+            case NODE16:
+            {
+                auto children = node->type == NODE4 ? static_cast<Node4*>(inner)->children : static_cast<Node16*>(inner)->children;
+                for (uint32_t i = 0U; i < inner->count; i += 1U)
+                {
+                    visit(children[i].ptr(), fn);
+                }
+                break;
+            }
+            case NODE48:
+            {
+                auto node48 = static_cast<Node48*>(inner);
+                for (uint32_t i = 0U; i < 256U; i += 1U)
+                {
+                    if (node48->index[i])
+                    {
+                        visit(node48->children[node48->index[i] - 1U].ptr(), fn);
+                    }
+                }
+                break;
+            }
+            default:
+            {
+                auto node256 = static_cast<Node256*>(inner);
+                for (uint32_t i = 0U; i < 256U; i += 1U)
+                {
+                    if (node256->children[i].hasRef())
+                    {
+                        visit(node256->children[i].ptr(), fn);
+                    }
+                }
+            }
+            }
+        }
+
+        static void destroy(Node* const node)
+        {
+            if (node->type != LEAF)
+            {
+                auto inner = asInner(node);
+                if (inner->leaf.hasRef())
+                {
+                    dropNode(inner->leaf.ptr());
+                }
+                destroyChildren(inner);
+            }
+            dropNode(node);
+        }
+
+        static void destroyChildren(Inner* const inner)
+        {
+            switch (inner->type)
+            {
+            case NODE4:
+            case NODE16:
+            {
+                auto children = inner->type == NODE4 ? static_cast<Node4*>(inner)->children : static_cast<Node16*>(inner)->children;
+                for (uint32_t i = 0U; i < inner->count; i += 1U)
+                {
+                    destroy(children[i].ptr());
+                }
+                break;
+            }
+            case NODE48:
+            {
+                auto node48 = static_cast<Node48*>(inner);
+                for (uint32_t i = 0U; i < 48U; i += 1U)
+                {
+                    if (node48->children[i].hasRef())
+                    {
+                        destroy(node48->children[i].ptr());
+                    }
+                }
+                break;
+            }
+            default:
+            {
+                auto node256 = static_cast<Node256*>(inner);
+                for (uint32_t i = 0U; i < 256U; i += 1U)
+                {
+                    if (node256->children[i].hasRef())
+                    {
+                        destroy(node256->children[i].ptr());
+                    }
+                }
+            }
+            }
+        }
+
+    public:
+        V* find(const std::string_view key) const
+        {
+            auto node = this->root();
+            std::size_t depth = 0U;
+            while (node)
+            {
+                if (node->type == LEAF)
+                {
+                    auto leaf = asLeaf(node);
+                    return leaf->key == key ? &leaf->value : nullptr;
+                }
+                auto inner = asInner(node);
+                if (inner->prefixLen)
+                {
+                    const uint32_t checkLen = inner->prefixLen < MAX_PREFIX ? inner->prefixLen : MAX_PREFIX;
+                    if (depth + checkLen > key.size() || std::memcmp(inner->prefix, key.data() + depth, checkLen) != 0)
+                    {
+                        return nullptr;
+                    }
+                    depth += inner->prefixLen;
+                }
+                if (depth >= key.size())
+                {
+                    auto leaf = inner->leaf.ptr();
+                    return leaf && leaf->key == key ? &leaf->value : nullptr;
+                }
+                auto child = findChild(inner, static_cast<uint8_t>(key[depth]));
+                node = child ? child->ptr() : nullptr;
+                depth += 1U;
+            }
+            return nullptr;
+        }
+
+        inline bool contains(const std::string_view key) const
+        {
+            return this->find(key) != nullptr;
+        }
+
+        inline bool insert(const std::string_view key, V value)
+        {
+            if (this->insert(this->_root, key, 0U, value))
+            {
+                this->_size += 1U;
+                return true;
+            }
+            return false;
+        }
+
+        inline bool remove(const std::string_view key)
+        {
+            if (this->remove(this->_root, key, 0U))
+            {
+                this->_size -= 1U;
+                return true;
+            }
+            return false;
+        }
+
+        /*
+        Calls fn(key, value) for every entry, in the lexicographic order of the keys.
+        */
+        template <typename F>
+        inline void forEach(F fn) const
+        {
+            auto root = this->root();
+            if (root)
+            {
+                visit(root, fn);
+            }
+        }
+
+        inline std::size_t size() const
+        {
+            return this->_size;
+        }
+
+        void clear()
+        {
+            auto root = this->_root.ptr();
+            if (root)
+            {
+                destroy(root);
+                this->_root.setPtr(nullptr);
+            }
+            this->_size = 0U;
+        }
+
+        inline CmpsArt<V>& operator=(const CmpsArt<V>&) = delete;
+        inline CmpsArt<V>(const CmpsArt<V>&) = delete;
+
+        inline CmpsArt<V>(CmpsArt<V>&& moved) : _size(moved._size)
+        {
+            this->_root.setPtr(moved._root.ptr());
+            moved._root.setPtr(nullptr);
+            moved._size = 0U;
+        }
+
+        inline CmpsArt<V>() {}
+
+        inline ~CmpsArt()
+        {
+            this->clear();
+        }
+    };
+}
+
+#endif // CMPSART_HPP
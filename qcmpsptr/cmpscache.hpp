@@ -0,0 +1,280 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSCACHE_HPP
+#define CMPSCACHE_HPP
+
+#include "cmpsptr.hpp"
+#include <functional>
+
+namespace cmpsptr
+{
+    /*
+    Concurrent cache evicting the least recently used entries, split into shards, each one guarded by its own mutex; the entries of a shard
+    are allocated from a block pool and linked in recency order by compressed pointers, while its index is an open-addressing table of
+    compressed entry pointers, probed linearly and compacted by backward shifting on removal, its size being the capacity of the shard
+    doubled and rounded up to a power of two. Besides the key and the 8 bytes of the counted value reference, an entry costs 8 bytes for
+    its links and 4 for its hash, while the index adds from 8 to 16 bytes, depending on the rounding, so 24 bytes per entry for 32-bit
+    keys and 8.4 more for the index at a capacity of a million. Values are shared by counted references, staying alive after their
+    eviction for as long as they are still held by readers.
+    */
+    template <typename K, typename V, const uint32_t shards = 16U, typename H = std::hash<K>>
+    class CmpsCache
+    {
+    protected:
+        struct Entry
+        {
+            CmpsPtr<Entry> prev;
+            CmpsPtr<Entry> next;
+            uint32_t hash;
+            K key;
+            CmpsCnt<V> value;
+
+            inline Entry(const uint32_t hash, const K& key, CmpsCnt<V>&& value) : hash(hash), key(key), value(std::move(value)) {}
+        };
+
+        struct alignas(64) Shard
+        {
+            CmpsMutex locker;
+            CmpsPtr<Entry> head;
+            CmpsPtr<Entry> tail;
+            std::vector<CmpsPtr<Entry>> slots;
+            uint32_t count = 0U;
+        };
+
+        std::array<Shard, shards> _shards;
+        uint32_t _shard_capacity;
+        uint32_t _mask;
+        H _hasher;
+
+        inline uint32_t hashOf(const K& key) const
+        {
+            const uint64_t hash = static_cast<uint64_t>(this->_hasher(key)) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<uint32_t>(hash >> 32);
+        }
+
+        inline Shard& shardOf(const uint32_t hash)
+        {
+            return this->_shards[hash % shards];
+        }
+
+        inline uint32_t home(const uint32_t hash) const
+        {
+            return (hash / shards) & this->_mask;
+        }
+
+        uint32_t lookup(Shard& shard, const uint32_t hash, const K& key) const
+        {
+            auto slots = shard.slots.data();
+            for (uint32_t idx = this->home(hash);; idx = (idx + 1U) & this->_mask)
+            {
+                auto entry = slots[idx].ptr();
+                if (entry == nullptr || (entry->hash == hash && entry->key == key))
+                {
+                    return idx;
+                }
+            }
+        }
+
+        void erase(Shard& shard, uint32_t idx)
+        {
+            auto slots = shard.slots.data();
+            const uint32_t mask = this->_mask;
+            for (uint32_t next = (idx + 1U) & mask;; next = (next + 1U) & mask)
+            {
+                auto entry = slots[next].ptr();
+                if (entry == nullptr)
+                {
+                    break;
+                }
+                const uint32_t entryHome = this->home(entry->hash);
+                if (((next - entryHome) & mask) >= ((next - idx) & mask))
+                {
+                    slots[idx].setPtr(entry);
+                    idx = next;
+                }
+            }
+            slots[idx].setPtr(nullptr);
+        }
+
+        static void unlink(Shard& shard, Entry* const entry)
+        {
+            auto prev = entry->prev.ptr();
+            auto next = entry->next.ptr();
+            if (prev)
+            {
+                prev->next.setPtr(next);
+            }
+            else
+            {
+                shard.head.setPtr(next);
+            }
+            if (next)
+            {
+                next->prev.setPtr(prev);
+            }
+            else
+            {
+                shard.tail.setPtr(prev);
+            }
+        }
+
+        static void pushFront(Shard& shard, Entry* const entry)
+        {
+            auto head = shard.head.ptr();
+            entry->prev.setPtr(nullptr);
+            entry->next.setPtr(head);
+            if (head)
+            {
+                head->prev.setPtr(entry);
+            }
+            else
+            {
+                shard.tail.setPtr(entry);
+            }
+            shard.head.setPtr(entry);
+        }
+
+        void evict(Shard& shard)
+        {
+            auto entry = shard.tail.ptr();
+            unlink(shard, entry);
+            this->erase(shard, this->lookup(shard, entry->hash, entry->key));
+            CmpsPool<Entry>::drop(entry);
+            shard.count -= 1U;
+        }
+
+    public:
+        /*
+        Returns a counted reference to the value cached for the key, marking it as the most recently used, or a null reference if missing.
+        */
+        CmpsCnt<V> get(const K& key)
+        {
+            const uint32_t hash = this->hashOf(key);
+            auto& shard = this->shardOf(hash);
+            auto uniqueLocker = CmpsLocker(&shard.locker);
+            auto entry = shard.slots[this->lookup(shard, hash, key)].ptr();
+            if (entry == nullptr)
+            {
+                return CmpsCnt<V>();
+            }
+            if (shard.head.ptr() != entry)
+            {
+                unlink(shard, entry);
+                pushFront(shard, entry);
+            }
+            return entry->value;
+        }
+
+        void put(const K& key, CmpsCnt<V> value)
+        {
+            const uint32_t hash = this->hashOf(key);
+            auto& shard = this->shardOf(hash);
+            auto uniqueLocker = CmpsLocker(&shard.locker);
+            auto idx = this->lookup(shard, hash, key);
+            auto entry = shard.slots[idx].ptr();
+            if (entry)
+            {
+                entry->value = std::move(value);
+                if (shard.head.ptr() != entry)
+                {
+                    unlink(shard, entry);
+                    pushFront(shard, entry);
+                }
+                return;
+            }
+            if (shard.count == this->_shard_capacity)
+            {
+                this->evict(shard);
+                idx = this->lookup(shard, hash, key);
+            }
+            entry = CmpsPool<Entry>::make(hash, key, std::move(value));
+            shard.slots[idx].setPtr(entry);
+            pushFront(shard, entry);
+            shard.count += 1U;
+        }
+
+        inline void put(const K& key, V value)
+        {
+            this->put(key, CmpsCnt<V>(new V(std::move(value))));
+        }
+
+        bool remove(const K& key)
+        {
+            const uint32_t hash = this->hashOf(key);
+            auto& shard = this->shardOf(hash);
+            auto uniqueLocker = CmpsLocker(&shard.locker);
+            const uint32_t idx = this->lookup(shard, hash, key);
+            auto entry = shard.slots[idx].ptr();
+            if (entry == nullptr)
+            {
+                return false;
+            }
+            unlink(shard, entry);
+            this->erase(shard, idx);
+            CmpsPool<Entry>::drop(entry);
+            shard.count -= 1U;
+            return true;
+        }
+
+        std::size_t size()
+        {
+            std::size_t size = 0U;
+            for (auto& shard : this->_shards)
+            {
+                auto uniqueLocker = CmpsLocker(&shard.locker);
+                size += shard.count;
+            }
+            return size;
+        }
+
+        void clear()
+        {
+            for (auto& shard : this->_shards)
+            {
+                auto uniqueLocker = CmpsLocker(&shard.locker);
+                auto entry = shard.head.ptr();
+                while (entry)
+                {
+                    auto next = entry->next.ptr();
+                    CmpsPool<Entry>::drop(entry);
+                    entry = next;
+                }
+                shard.head.setPtr(nullptr);
+                shard.tail.setPtr(nullptr);
+                std::fill(shard.slots.begin(), shard.slots.end(), CmpsPtr<Entry>());
+                shard.count = 0U;
+            }
+        }
+
+        inline CmpsCache<K, V, shards, H>& operator=(const CmpsCache<K, V, shards, H>&) = delete;
+        inline CmpsCache<K, V, shards, H>(const CmpsCache<K, V, shards, H>&) = delete;
+
+        CmpsCache<K, V, shards, H>(const std::size_t capacity, const H& hasher = H()) : _hasher(hasher)
+        {
+            const std::size_t shardCapacity = (capacity + shards - 1U) / shards;
+            this->_shard_capacity = static_cast<uint32_t>(shardCapacity ? shardCapacity : 1U);
+            uint32_t slotCount = 2U;
+            while (slotCount < this->_shard_capacity * 2U)
+            {
+                slotCount <<= 1;
+            }
+            this->_mask = slotCount - 1U;
+            for (auto& shard : this->_shards)
+            {
+                shard.slots.resize(slotCount);
+            }
+        }
+
+        inline ~CmpsCache()
+        {
+            this->clear();
+        }
+    };
+}
+
+#endif // CMPSCACHE_HPP
@@ -0,0 +1,363 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSHEAP_HPP
+#define CMPSHEAP_HPP
+
+#include "cmpsptr.hpp"
+#include <functional>
+
+namespace cmpsptr
+{
+    /*
+    Pairing heap, whose nodes are allocated from a block pool and linked by compressed pointers to their first child, their next sibling
+    and their previous sibling, or their parent, in the case of first children, so that each node carries only 12 bytes of links.
+    The top of the heap is the node whose key is not preceded by any other, according to F; keys can be decreased (moved towards the
+    top) through the node pointers returned when pushing, the node being cut from its parent and merged again with the root, while
+    removing the top merges its children in two passes, first pairwise from left to right, then from right to left.
+    */
+    template <typename K, typename V, typename F = std::less<K>>
+    class CmpsPairHeap
+    {
+    public:
+        class Node
+        {
+            CmpsPtr<Node> _child;
+            CmpsPtr<Node> _next;
+            CmpsPtr<Node> _prev;
+
+        public:
+            K key;
+            V value;
+
+            inline Node(K&& key, V&& value) : key(std::move(key)), value(std::move(value)) {}
+
+            friend class CmpsPairHeap<K, V, F>;
+        };
+
+    protected:
+        CmpsPtr<Node> _root;
+        std::size_t _size = 0U;
+        F _comp;
+
+        Node* meld(Node* first, Node* second) const
+        {
+            if (second == nullptr)
+            {
+                return first;
+            }
+            if (this->_comp(second->key, first->key))
+            {
+                std::swap(first, second);
+            }
+            auto child = first->_child.ptr();
+            second->_next.setPtr(child);
+            if (child)
+            {
+                child->_prev.setPtr(second);
+            }
+            second->_prev.setPtr(first);
+            first->_child.setPtr(second);
+            return first;
+        }
+
+        Node* mergePairs(Node* first) const
+        {
+            if (first == nullptr)
+            {
+                return nullptr;
+            }
+            Node* pairs = nullptr;
+            while (first)
+            {
+                auto second = first->_next.ptr();
+                auto next = second ? second->_next.ptr() : nullptr;
+                first->_prev.setPtr(nullptr);
+                first->_next.setPtr(nullptr);
+                if (second)
+                {
+                    second->_prev.setPtr(nullptr);
+                    second->_next.setPtr(nullptr);
+                }
+                auto pair = this->meld(first, second);
+                pair->_next.setPtr(pairs);
+                pairs = pair;
+                first = next;
+            }
+            auto root = pairs;
+            pairs = root->_next.ptr();
+            root->_next.setPtr(nullptr);
+            while (pairs)
+            {
+                auto next = pairs->_next.ptr();
+                pairs->_next.setPtr(nullptr);
+                root = this->meld(root, pairs);
+                pairs = next;
+            }
+            return root;
+        }
+
+        static void cut(Node* const node)
+        {
+            auto prev = node->_prev.ptr();
+            auto next = node->_next.ptr();
+            if (prev->_child.ptr() == node)
+            {
+                prev->_child.setPtr(next);
+            }
+            else
+            {
+                prev->_next.setPtr(next);
+            }
+            if (next)
+            {
+                next->_prev.setPtr(prev);
+            }
+            node->_prev.setPtr(nullptr);
+            node->_next.setPtr(nullptr);
+        }
+
+        static void destroy(Node* const root)
+        {
+            std::vector<Node*> nodes;
+            if (root)
+            {
+                nodes.push_back(root);
+            }
+            while (!nodes.empty())
+            {
+                auto node = nodes.back();
+                nodes.pop_back();
+                auto child = node->_child.ptr();
+                if (child)
+                {
+                    nodes.push_back(child);
+                }
+                auto next = node->_next.ptr();
+                if (next)
+                {
+                    nodes.push_back(next);
+                }
+                CmpsPool<Node>::drop(node);
+            }
+        }
+
+    public:
+        inline Node* top() const
+        {
+            return const_cast<CmpsPtr<Node>&>(this->_root).ptr();
+        }
+
+        inline std::size_t size() const
+        {
+            return this->_size;
+        }
+
+        inline bool empty() const
+        {
+            return this->_size == 0U;
+        }
+
+        Node* push(K key, V value)
+        {
+            auto node = CmpsPool<Node>::make(std::move(key), std::move(value));
+            this->_root.setPtr(this->meld(node, this->_root.ptr()));
+            this->_size += 1U;
+            return node;
+        }
+
+        void pop()
+        {
+            auto root = this->_root.ptr();
+            if (root)
+            {
+                this->_root.setPtr(this->mergePairs(root->_child.ptr()));
+                CmpsPool<Node>::drop(root);
+                this->_size -= 1U;
+            }
+        }
+
+        /*
+        Moves the node towards the top, by replacing its key with one which must not follow the current one, according to F.
+        */
+        void decrease(Node* const node, K key)
+        {
+            node->key = std::move(key);
+            auto root = this->_root.ptr();
+            if (node != root)
+            {
+                cut(node);
+                this->_root.setPtr(this->meld(root, node));
+            }
+        }
+
+        void erase(Node* const node)
+        {
+            auto root = this->_root.ptr();
+            if (node == root)
+            {
+                this->pop();
+                return;
+            }
+            cut(node);
+            auto children = this->mergePairs(node->_child.ptr());
+            this->_root.setPtr(this->meld(root, children));
+            CmpsPool<Node>::drop(node);
+            this->_size -= 1U;
+        }
+
+        void clear()
+        {
+            destroy(this->_root.ptr());
+            this->_root.setPtr(nullptr);
+            this->_size = 0U;
+        }
+
+        inline CmpsPairHeap<K, V, F>& operator=(const CmpsPairHeap<K, V, F>&) = delete;
+        inline CmpsPairHeap<K, V, F>(const CmpsPairHeap<K, V, F>&) = delete;
+
+        inline CmpsPairHeap<K, V, F>(const F& comp = F()) : _comp(comp) {}
+
+        inline ~CmpsPairHeap()
+        {
+            this->clear();
+        }
+    };
+
+    /*
+    Implicit heap with d children per node, stored in an array of keys paired with compressed pointers to the objects they refer to,
+    so that an entry with a 32bit key takes 8 bytes and a cache line holds the children of two nodes, when d is 4; entries are moved
+    into the holes left while sifting, instead of being swapped. The top entry has the key not preceded by any other, according to F.
+    */
+    template <typename K, typename T, const uint32_t d = 4U, typename F = std::less<K>>
+    class CmpsDHeap
+    {
+        static_assert(d > 1U, "Heap nodes must have at least two children.");
+
+    public:
+        struct Entry
+        {
+            K key;
+            CmpsPtr<T> ptr;
+        };
+
+    protected:
+        std::vector<Entry> _entries;
+        F _comp;
+
+    public:
+        inline const Entry& top() const
+        {
+            return this->_entries.front();
+        }
+
+        inline std::size_t size() const
+        {
+            return this->_entries.size();
+        }
+
+        inline bool empty() const
+        {
+            return this->_entries.empty();
+        }
+
+        inline void reserve(const std::size_t size)
+        {
+            this->_entries.reserve(size);
+        }
+
+        void push(K key, T* const ptr)
+        {
+            auto& entries = this->_entries;
+            entries.emplace_back();
+            std::size_t hole = entries.size() - 1U;
+            while (hole > 0U)
+            {
+                const std::size_t parent = (hole - 1U) / d;
+                if (!this->_comp(key, entries[parent].key))
+                {
+                    break;
+                }
+                entries[hole].key = std::move(entries[parent].key);
+                entries[hole].ptr = std::move(entries[parent].ptr);
+                hole = parent;
+            }
+            CmpsPtr<T> fresh;
+            fresh.setPtr(ptr);
+            entries[hole].key = std::move(key);
+            entries[hole].ptr = std::move(fresh);
+        }
+
+        /*
+        Removes the top entry, returning the pointer it held.
+        */
+        T* pop()
+        {
+            auto& entries = this->_entries;
+            if (entries.empty())
+            {
+                return nullptr;
+            }
+            auto ptr = entries.front().ptr.takePtr();
+            const std::size_t size = entries.size() - 1U;
+            if (size > 0U)
+            {
+                auto& last = entries[size];
+                std::size_t hole = 0U;
+                for (;;)
+                {
+                    const std::size_t first = hole * d + 1U;
+                    if (first >= size)
+                    {
+                        break;
+                    }
+                    const std::size_t end = first + d < size ? first + d : size;
+                    std::size_t best = first;
+                    for (std::size_t child = first + 1U; child < end; child += 1U)
+                    {
+                        if (this->_comp(entries[child].key, entries[best].key))
+                        {
+                            best = child;
+                        }
+                    }
+                    if (!this->_comp(entries[best].key, last.key))
+                    {
+                        break;
+                    }
+                    entries[hole].key = std::move(entries[best].key);
+                    entries[hole].ptr = std::move(entries[best].ptr);
+                    hole = best;
+                }
+                if (hole != size)
+                {
+                    entries[hole].key = std::move(last.key);
+                    entries[hole].ptr = std::move(last.ptr);
+                }
+            }
+            entries.pop_back();
+            return ptr;
+        }
+
+        void clear()
+        {
+            for (auto& entry : this->_entries)
+            {
+                entry.ptr.setPtr(nullptr);
+            }
+            this->_entries.clear();
+        }
+
+        inline CmpsDHeap<K, T, d, F>(const F& comp = F()) : _comp(comp) {}
+
+        inline ~CmpsDHeap()
+        {
+            this->clear();
+        }
+    };
+}
+
+#endif // CMPSHEAP_HPP
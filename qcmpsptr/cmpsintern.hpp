@@ -0,0 +1,282 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSINTERN_HPP
+#define CMPSINTERN_HPP
+
+#include "cmpsptr.hpp"
+#include <string_view>
+
+namespace cmpsptr
+{
+    /*
+    Handle of an interned string, holding the 32bit arena offset of its record, so that handles of equal strings are equal integers and
+    hash to their own value; the record stores the hash and the length of the string, followed by its null-terminated characters.
+    */
+    class CmpsAtom
+    {
+    protected:
+        struct Record
+        {
+            uint32_t hash;
+            uint32_t length;
+            char text[1];
+        };
+
+        uint32_t _id = 0U;
+
+        inline const Record* record() const
+        {
+            return static_cast<const Record*>(CmpsArena::global().expand(this->_id));
+        }
+
+        inline CmpsAtom(const uint32_t id) : _id(id) {}
+
+    public:
+        inline uint32_t id() const
+        {
+            return this->_id;
+        }
+
+        /*
+        Hash of the characters, as computed when the string was interned, which does not depend on the order of interning, unlike the handle;
+        it comes from std::hash, so it is not guaranteed to stay the same across processes or standard libraries and should not be persisted.
+        */
+        inline uint32_t hash() const
+        {
+            return this->_id ? this->record()->hash : 0U;
+        }
+
+        inline uint32_t size() const
+        {
+            return this->_id ? this->record()->length : 0U;
+        }
+
+        inline const char* c_str() const
+        {
+            return this->_id ? this->record()->text : "";
+        }
+
+        inline std::string_view view() const
+        {
+            return this->_id ? std::string_view(this->record()->text, this->record()->length) : std::string_view();
+        }
+
+        inline operator bool() const
+        {
+            return this->_id != 0U;
+        }
+
+        inline bool operator==(const CmpsAtom other) const
+        {
+            return this->_id == other._id;
+        }
+
+        inline bool operator!=(const CmpsAtom other) const
+        {
+            return this->_id != other._id;
+        }
+
+        inline bool operator<(const CmpsAtom other) const
+        {
+            return this->_id < other._id;
+        }
+
+        inline CmpsAtom() {}
+
+        template <const uint32_t> friend class CmpsInterner;
+    };
+
+    /*
+    Concurrent string interner, storing each distinct string once, in a record allocated from the arena, and returning CmpsAtom handles;
+    the strings are split into shards by hash, each shard being guarded by its own mutex and indexed by an open-addressing table of
+    32bit record offsets, probed linearly and doubled when half full, so that the index costs between 8 and 16 bytes per string.
+    Records are released only when the interner is destroyed, so handles remain valid for as long as it is alive.
+    */
+    template <const uint32_t shards = 64U>
+    class CmpsInterner
+    {
+    protected:
+        using Record = CmpsAtom::Record;
+
+        struct alignas(64) Shard
+        {
+            CmpsMutex locker;
+            std::vector<uint32_t> slots;
+            uint32_t count = 0U;
+        };
+
+        std::array<Shard, shards> _shards;
+
+        inline static uint32_t hashOf(const std::string_view text)
+        {
+            const uint64_t hash = static_cast<uint64_t>(std::hash<std::string_view>()(text)) * 0x9E3779B97F4A7C15ULL;
+            return static_cast<uint32_t>(hash >> 32);
+        }
+
+        inline static const Record* recordAt(const uint32_t id)
+        {
+            return static_cast<const Record*>(CmpsArena::global().expand(id));
+        }
+
+        inline static std::size_t recordSize(const uint32_t length)
+        {
+            return offsetof(Record, text) + length + 1U;
+        }
+
+        static uint32_t* lookup(Shard& shard, const uint32_t hash, const std::string_view text)
+        {
+            auto slots = shard.slots.data();
+            const uint32_t mask = static_cast<uint32_t>(shard.slots.size()) - 1U;
+            for (uint32_t idx = (hash / shards) & mask;; idx = (idx + 1U) & mask)
+            {
+                const uint32_t id = slots[idx];
+                if (id == 0U)
+                {
+                    return slots + idx;
+                }
+                auto record = recordAt(id);
+                if (record->hash == hash && record->length == text.size() && std::memcmp(record->text, text.data(), text.size()) == 0)
+                {
+                    return slots + idx;
+                }
+            }
+        }
+
+        static void grow(Shard& shard)
+        {
+            std::vector<uint32_t> slots(shard.slots.size() * 2U);
+            const uint32_t mask = static_cast<uint32_t>(slots.size()) - 1U;
+            for (const uint32_t id : shard.slots)
+            {
+                if (id)
+                {
+                    uint32_t idx = (recordAt(id)->hash / shards) & mask;
+                    while (slots[idx])
+                    {
+                        idx = (idx + 1U) & mask;
+                    }
+                    slots[idx] = id;
+                }
+            }
+            shard.slots.swap(slots);
+        }
+
+    public:
+        /*
+        Returns the handle of the string, storing a copy of it first, if it was not interned before.
+        */
+        CmpsAtom intern(const std::string_view text)
+        {
+            const uint32_t hash = hashOf(text);
+            auto& shard = this->_shards[hash % shards];
+            auto uniqueLocker = CmpsLocker(&shard.locker);
+            auto slot = lookup(shard, hash, text);
+            if (*slot)
+            {
+                return CmpsAtom(*slot);
+            }
+            const uint32_t length = static_cast<uint32_t>(text.size());
+            auto& arena = CmpsArena::global();
+            auto record = static_cast<Record*>(arena.allocate(recordSize(length)));
+            if (record == nullptr)
+            {
+                throw std::bad_alloc {};
+            }
+            record->hash = hash;
+            record->length = length;
+            std::memcpy(record->text, text.data(), length);
+            record->text[length] = '\0';
+            const uint32_t id = arena.compress(record);
+            *slot = id;
+            shard.count += 1U;
+            if (shard.count * 2U > shard.slots.size())
+            {
+                grow(shard);
+            }
+            return CmpsAtom(id);
+        }
+
+        /*
+        Returns the handle of the string, or a null handle if it was not interned.
+        */
+        CmpsAtom find(const std::string_view text)
+        {
+            const uint32_t hash = hashOf(text);
+            auto& shard = this->_shards[hash % shards];
+            auto uniqueLocker = CmpsLocker(&shard.locker);
+            return CmpsAtom(*lookup(shard, hash, text));
+        }
+
+        std::size_t size()
+        {
+            std::size_t size = 0U;
+            for (auto& shard : this->_shards)
+            {
+                auto uniqueLocker = CmpsLocker(&shard.locker);
+                size += shard.count;
+            }
+            return size;
+        }
+
+        /*
+        The process-wide interner is never destroyed, like the arena holding its records, so handles kept by other static objects can still
+        be read while the program exits.
+        */
+        static CmpsInterner<shards>& global()
+        {
+            static CmpsInterner<shards>& interner = *new CmpsInterner<shards>;
+            return interner;
+        }
+
+        inline CmpsInterner<shards>& operator=(const CmpsInterner<shards>&) = delete;
+        inline CmpsInterner<shards>(const CmpsInterner<shards>&) = delete;
+
+        CmpsInterner<shards>(const uint32_t shardCapacity = 64U)
+        {
+            uint32_t slotCount = 2U;
+            while (slotCount < shardCapacity * 2U)
+            {
+                slotCount <<= 1;
+            }
+            for (auto& shard : this->_shards)
+            {
+                shard.slots.resize(slotCount);
+            }
+        }
+
+        ~CmpsInterner()
+        {
+            auto& arena = CmpsArena::global();
+            for (auto& shard : this->_shards)
+            {
+                for (const uint32_t id : shard.slots)
+                {
+                    if (id)
+                    {
+                        auto record = const_cast<Record*>(recordAt(id));
+                        arena.release(record, recordSize(record->length));
+                    }
+                }
+            }
+        }
+    };
+}
+
+namespace std
+{
+    template <>
+    struct hash<cmpsptr::CmpsAtom>
+    {
+        inline std::size_t operator()(const cmpsptr::CmpsAtom atom) const noexcept
+        {
+            return atom.id();
+        }
+    };
+}
+
+#endif // CMPSINTERN_HPP
@@ -9,19 +9,79 @@ file, You can obtain one at https://mozilla.org/MPL/2.0/.
 #define CMPSPTR_HPP
 
 #include <cstring>
+#include <algorithm>
 #include <atomic>
 #include <mutex>
+#include <deque>
+#include <thread>
+#include <memory>
+#include <functional>
+#include <condition_variable>
+#include <map>
+#include <array>
+#include <memory_resource>
+#include <cstdint>
+#include <cassert>
+#include <vector>
 
+/*
+Defining the CMPS_STD_ONLY macro, or building without QtCore being available, selects the standard library backend, which replaces QMutex
+with the CmpsLock below and takes the platform details from the compiler, instead of the Qt macros.
+*/
+#if !defined(CMPS_STD_ONLY) && defined(__has_include)
+    #if !__has_include(<QMutex>)
+        #define CMPS_STD_ONLY 1
+    #endif
+#endif
+#ifdef CMPS_STD_ONLY
+    #ifdef _WIN32
+        #define CMPS_OS_WINDOWS 1
+    #elif defined(__ANDROID__)
+        #define CMPS_OS_ANDROID 1
+    #endif
+    #if UINTPTR_MAX > 0xFFFFFFFFU
+        #define CMPS_WORDSIZE 8
+    #else
+        #define CMPS_WORDSIZE 4
+    #endif
+#else
 #include <QMap>
 #include <QDebug>
 #include <QMutex>
+#include <QByteArray>
+#include <QDataStream>
 #include <QCoreApplication>
+    #ifdef Q_OS_WINDOWS
+        #define CMPS_OS_WINDOWS 1
+    #elif defined(Q_OS_ANDROID)
+        #define CMPS_OS_ANDROID 1
+    #endif
+    #define CMPS_WORDSIZE Q_PROCESSOR_WORDSIZE
+#endif
 
-#ifdef Q_OS_ANDROID
+#ifdef CMPS_OS_ANDROID
 #include <stdlib.h>
 #endif
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if __cplusplus > 201703L && defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define CMPS_COROUTINES 1
+#include <coroutine>
+#endif
+#ifdef CMPS_OS_WINDOWS
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CMPS_X86_SIMD 1
+#include <immintrin.h>
+#endif
 
-#if Q_PROCESSOR_WORDSIZE > 4
+#if CMPS_WORDSIZE > 4
 /*
 If the COMPRESS_POINTERS macro is set to a non-zero value, 64bit pointers will be compressed into 32bit integers, according to the following options:
     +5 can compress addresses up to 32GB, at the expense of the 4 lower tag bits, which can no longer be used for other purporses
@@ -48,6 +108,108 @@ thus allowing compression of larger adresses, but will reduce usable memory, as
 
 namespace cmpsptr
 {
+    /*
+    Lock word which is 0 when free, 1 when held and 2 when other threads might be waiting for it; contended threads spin shortly, then
+    sleep on a futex on Linux, or yield on other platforms, so that the uncontended paths cost a single atomic operation each.
+    */
+    class CmpsLock
+    {
+        std::atomic<uint32_t> _state = 0U;
+
+        inline static void pause()
+        {
+    #ifdef CMPS_X86_SIMD
+            _mm_pause();
+    #else
+            std::this_thread::yield();
+    #endif
+        }
+
+        inline void wait()
+        {
+    #ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&this->_state), FUTEX_WAIT_PRIVATE, 2U, nullptr, nullptr, 0);
+    #else
+            std::this_thread::yield();
+    #endif
+        }
+
+        inline void wake()
+        {
+    #ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&this->_state), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+    #endif
+        }
+
+    public:
+        inline bool tryLock()
+        {
+            uint32_t state = 0U;
+            return this->_state.compare_exchange_strong(state, 1U, std::memory_order_acquire, std::memory_order_relaxed);
+        }
+
+        void lock()
+        {
+            for (int i = 0; i < 64; i += 1)
+            {
+                if (this->tryLock())
+                {
+                    return;
+                }
+                if (this->_state.load(std::memory_order_relaxed) == 2U)
+                {
+                    break;
+                }
+                pause();
+            }
+            while (this->_state.exchange(2U, std::memory_order_acquire) != 0U)
+            {
+                this->wait();
+            }
+        }
+
+        inline void unlock()
+        {
+            if (this->_state.exchange(0U, std::memory_order_release) == 2U)
+            {
+                this->wake();
+            }
+        }
+    };
+
+    template <typename M>
+    class CmpsLocker
+    {
+        M* _mutex;
+
+    public:
+        inline void unlock()
+        {
+            if (this->_mutex)
+            {
+                this->_mutex->unlock();
+                this->_mutex = nullptr;
+            }
+        }
+
+        CmpsLocker(const CmpsLocker<M>&) = delete;
+        CmpsLocker<M>& operator=(const CmpsLocker<M>&) = delete;
+
+        inline explicit CmpsLocker(M* const mutex) : _mutex(mutex)
+        {
+            mutex->lock();
+        }
+
+        inline ~CmpsLocker()
+        {
+            this->unlock();
+        }
+    };
+#ifdef CMPS_STD_ONLY
+    using CmpsMutex = CmpsLock;
+#else
+    using CmpsMutex = QMutex;
+#endif
 
 #define CONVERT_DELEGATE(Type, Attribute, Field) \
     Attribute operator Type() const { return Field; } \
@@ -360,8 +522,8 @@ namespace cmpsptr
             return *ptr;
         }
 
-        template<typename R = T&>
-        inline auto refOrDef() const -> std::enable_if_t<std::is_nothrow_default_constructible<T>::value, R>
+        template<typename R = T&, typename D = T>
+        inline auto refOrDef() const -> std::enable_if_t<std::is_nothrow_default_constructible<D>::value, R>
         {
             return this->def();
         }
@@ -444,17 +606,276 @@ namespace cmpsptr
         inline BasePtr<T, P, opt>()
         {
             static_assert(opt != 0 && opt > -2, "This reference is not optional and must be initialized.");
+#if COMPRESS_POINTERS > 0
+            static_cast<P*>(this)->P::_ptr = 0U;
+#endif
             static_cast<P*>(this)->P::setAddr(nullptr);
         }
     };
+#if COMPRESS_POINTERS != 0
+    /*
+    Watermarks are expressed as percentages of the compressible window (4294967295UL << SHIFT_LEN) and are checked against the compressed
+    value stored by setAddr, so that the hot path only costs a relaxed load and a comparison; each callback fires once, from the thread which
+    stored the first address passing its mark, while addresses which cannot be compressed at all are reported as reaching 100%.
+    */
+    class HeapMark
+    {
+    public:
+        typedef void (*Callback)(const uint32_t percent, const void* const ptr);
+
+    protected:
+        static constexpr int MAX_MARKS = 8;
+
+        struct Mark
+        {
+            uint32_t limit;
+            uint32_t percent;
+            Callback callback;
+            bool fired;
+        };
+
+        inline static Mark _marks[MAX_MARKS];
+        inline static int _marks_len = 0;
+        inline static std::atomic<uint32_t> _next_mark = 4294967295U;
+        inline static CmpsMutex _locker;
+
+        static void updateNext()
+        {
+            uint32_t nextMark = 4294967295U;
+            for (int i = 0; i < _marks_len; i += 1)
+            {
+                auto& mark = _marks[i];
+                if ((!mark.fired) && mark.limit < nextMark)
+                {
+                    nextMark = mark.limit;
+                }
+            }
+            _next_mark.store(nextMark, std::memory_order_relaxed);
+        }
+
+        static void reach(const uint32_t value, const void* const ptr)
+        {
+            Mark reached[MAX_MARKS];
+            int reachedLen = 0;
+            {
+                auto uniqueLocker = CmpsLocker(&HeapMark::_locker);
+                for (int i = 0; i < _marks_len; i += 1)
+                {
+                    auto& mark = _marks[i];
+                    if ((!mark.fired) && value >= mark.limit)
+                    {
+                        mark.fired = true;
+                        int j = reachedLen++;
+                        for (; j > 0 && reached[j - 1].limit > mark.limit; j -= 1)
+                        {
+                            reached[j] = reached[j - 1];
+                        }
+                        reached[j] = mark;
+                    }
+                }
+                updateNext();
+            }
+            for (int i = 0; i < reachedLen; i += 1)
+            {
+                reached[i].callback(reached[i].percent, ptr);
+            }
+        }
+
+        inline static void check(const uint32_t value, const void* const ptr)
+        {
+            if (value >= _next_mark.load(std::memory_order_relaxed))
+            {
+                reach(value, ptr);
+            }
+        }
+
+    public:
+        static bool addWatermark(const uint32_t percent, Callback callback)
+        {
+            if (percent == 0U || percent > 100U || callback == nullptr)
+            {
+                return false;
+            }
+            auto uniqueLocker = CmpsLocker(&HeapMark::_locker);
+            if (_marks_len == MAX_MARKS)
+            {
+                return false;
+            }
+            _marks[_marks_len++] = { static_cast<uint32_t>((4294967295ULL * percent) / 100U), percent, callback, false };
+            updateNext();
+            return true;
+        }
+
+        static void resetWatermarks(const bool remove = false)
+        {
+            auto uniqueLocker = CmpsLocker(&HeapMark::_locker);
+            if (remove)
+            {
+                _marks_len = 0;
+            }
+            else
+            {
+                for (int i = 0; i < _marks_len; i += 1)
+                {
+                    _marks[i].fired = false;
+                }
+            }
+            updateNext();
+        }
+
+        template<typename, const int, const int, const int> friend class BaseCmp;
+    };
+#endif
+    /*
+    Storage of compressed pointers, declaring copy, move and destruction only when they own their targets, or can fall back to the pointer
+    list, whose slots must not be shared by moved-from pointers, so that the other non-owning pointers stay trivially copyable and trivially
+    destructible, being passed in registers and copied by containers as plain integers.
+    */
+    template <class P, class S, const bool managed>
+    struct CmpsStore : S {};
+
+    template <class P, class S>
+    struct CmpsStore<P, S, true> : S
+    {
+        inline CmpsStore() = default;
+
+        inline CmpsStore(const CmpsStore& cloned)
+        {
+            this->_ptr = 0U;
+            static_cast<P*>(this)->copy(static_cast<const P&>(cloned));
+        }
+
+        inline CmpsStore(CmpsStore&& cloned) noexcept
+        {
+            this->_ptr = 0U;
+            static_cast<P*>(this)->move(static_cast<P&&>(cloned));
+        }
+
+        inline CmpsStore& operator=(const CmpsStore& cloned)
+        {
+            if (this != &cloned)
+            {
+                static_cast<P*>(this)->copy(static_cast<const P&>(cloned));
+            }
+            return *this;
+        }
+
+        inline CmpsStore& operator=(CmpsStore&& cloned) noexcept
+        {
+            if (this != &cloned)
+            {
+                static_cast<P*>(this)->move(static_cast<P&&>(cloned));
+            }
+            return *this;
+        }
+
+        inline ~CmpsStore()
+        {
+            P::dispose(this->_ptr);
+        }
+    };
+
+    template <typename V>
+    struct CmpsRaw
+    {
+    protected:
+        V _ptr;
+    };
 #if COMPRESS_POINTERS > 0
+    /*
+    Slots of the pointer list, kept in chunks which double in size and are never moved, so that listed pointers are decoded without
+    locking, or checking whether the storage is shared; chunk c holds 64 << c slots, so 26 chunks cover the 31bit indexes of listed values.
+    Slots are only written while holding the lock of the pointer list, but are read without it, so they are atomic, stored with release
+    and loaded with acquire ordering, making the pointed object visible to the threads decoding its index.
+    */
+    class PtrSlots
+    {
+        static constexpr uint32_t CHUNK_BITS = 6U;
+        static constexpr uint32_t CHUNK_COUNT = 26U;
+
+        std::atomic<std::atomic<void*>*> _chunks[CHUNK_COUNT] = {};
+        uint32_t _size = 0U;
+
+        inline static uint32_t chunkOf(const uint32_t idx)
+        {
+            const uint32_t chunks = (idx >> CHUNK_BITS) + 1U;
+    #ifdef __GNUC__
+            return 31U - static_cast<uint32_t>(__builtin_clz(chunks));
+    #else
+            uint32_t chunk = 0U;
+            while ((chunks >> (chunk + 1U)) > 0U)
+            {
+                chunk += 1U;
+            }
+            return chunk;
+    #endif
+        }
+
+        inline static uint32_t startOf(const uint32_t chunk)
+        {
+            return ((1U << chunk) - 1U) << CHUNK_BITS;
+        }
+
+        inline std::atomic<void*>& slot(const uint32_t idx) const
+        {
+            const uint32_t chunk = chunkOf(idx);
+            return this->_chunks[chunk].load(std::memory_order_acquire)[idx - startOf(chunk)];
+        }
+
+    public:
+        inline uint32_t size() const
+        {
+            return this->_size;
+        }
+
+        inline void* operator[](const uint32_t idx) const
+        {
+            return this->slot(idx).load(std::memory_order_acquire);
+        }
+
+        inline void* at(const uint32_t idx) const
+        {
+            return this->slot(idx).load(std::memory_order_acquire);
+        }
+
+        inline void set(const uint32_t idx, void* const ptr)
+        {
+            this->slot(idx).store(ptr, std::memory_order_release);
+        }
+
+        void push_back(void* const ptr)
+        {
+            const uint32_t idx = this->_size;
+            const uint32_t chunk = chunkOf(idx);
+            if (this->_chunks[chunk].load(std::memory_order_relaxed) == nullptr)
+            {
+                this->_chunks[chunk].store(new std::atomic<void*>[static_cast<std::size_t>(1U) << (chunk + CHUNK_BITS)], std::memory_order_release);
+            }
+            this->set(idx, ptr);
+            this->_size = idx + 1U;
+        }
+
+        inline void pop_back()
+        {
+            this->_size -= 1U;
+        }
+
+        inline ~PtrSlots()
+        {
+            for (auto& chunk : this->_chunks)
+            {
+                delete[] chunk.load(std::memory_order_relaxed);
+            }
+        }
+    };
+
     class PtrList
     {
     protected:
         inline static uint32_t _null_idx = 0U;
-        inline static QVector<void*> _ptr_list;
+        inline static PtrSlots _ptr_list;
         //inline static std::mutex _locker;
-        inline static QMutex _locker;
+        inline static CmpsMutex _locker;
 
         inline static bool listed(const uint32_t ptr)
         {
@@ -470,7 +891,7 @@ namespace cmpsptr
             if (listed(ptr))
             {
                 //auto uniqueLocker = std::unique_lock(PtrList::_locker);
-                auto uniqueLocker = QMutexLocker(&PtrList::_locker);
+                auto uniqueLocker = CmpsLocker(&PtrList::_locker);
                 //uniqueLocker.lock();
                 //_locker.lock();
                 auto ptrList = &_ptr_list;
@@ -493,7 +914,7 @@ namespace cmpsptr
                     auto idx = ptr - 1U;
                     if (idx < ptrList->size())
                     {
-                        (*ptrList)[idx] = nullptr;
+                        ptrList->set(idx, nullptr);
                         if (idx < _null_idx)
                         {
                             _null_idx = idx;
@@ -511,7 +932,7 @@ namespace cmpsptr
             //qDebug() << "listPtr: ptr = " << ptr;
             uint32_t oldPtr = this->_ptr;
             //auto uniqueLocker = std::unique_lock(PtrList::_locker);
-            auto uniqueLocker = QMutexLocker(&PtrList::_locker);
+            auto uniqueLocker = CmpsLocker(&PtrList::_locker);
             //uniqueLocker.lock();
             //_locker.lock();
             auto ptrList = &_ptr_list;
@@ -520,7 +941,7 @@ namespace cmpsptr
                 oldPtr >>= 1;
                 if (oldPtr > 0U)
                 {
-                    (*ptrList)[oldPtr - 1U] = const_cast<void*>(reinterpret_cast<const void*>(ptr));
+                    ptrList->set(oldPtr - 1U, const_cast<void*>(reinterpret_cast<const void*>(ptr)));
                     return;
                 }
             }
@@ -530,7 +951,7 @@ namespace cmpsptr
                 if (ptrList->at(i) == nullptr)
                 {
                     //_null_idx = i == ptrListLen - 1 ? 0U : i + 1U;
-                    ptrList->operator[](i++) = const_cast<void*>(reinterpret_cast<const void*>(ptr));
+                    ptrList->set(i++, const_cast<void*>(reinterpret_cast<const void*>(ptr)));
                     this->_ptr = (i << 1U) | 1U;
                     _null_idx = i;
                     return;
@@ -548,8 +969,12 @@ namespace cmpsptr
     };
 #define CMPS_LEVEL COMPRESS_POINTERS - 2
     template<typename T, const int own = 0, const int opt = -1, const int level = CMPS_LEVEL>
-    class BaseCmp : public BasePtr<T, BaseCmp<T, own, opt, level>, opt>, protected PtrList
+    class BaseCmp : public BasePtr<T, BaseCmp<T, own, opt, level>, opt>, protected CmpsStore<BaseCmp<T, own, opt, level>, PtrList, true>
     {
+        using PtrList::listed;
+        using PtrList::clearList;
+        using PtrList::_ptr_list;
+
         static constexpr uint32_t CmpsLengthShift(int cmpsLevel)
         {
             if (cmpsLevel == -1)
@@ -570,9 +995,8 @@ namespace cmpsptr
         }
 
     protected:
-        inline T* addr() const
+        inline static T* decode(const uint32_t ptr)
         {
-            auto ptr = this->_ptr;
             if (ptr == 0U)
             {
                 return nullptr;
@@ -583,10 +1007,28 @@ namespace cmpsptr
             }
             else
             {
-                return reinterpret_cast<T*>(static_cast<uintptr_t>(this->_ptr) << SHIFT_LEN);
+                return reinterpret_cast<T*>(static_cast<uintptr_t>(ptr) << SHIFT_LEN);
+            }
+        }
+
+        static void dispose(const uint32_t ptr)
+        {
+            if constexpr(own != 0)
+            {
+                auto addr = decode(ptr);
+                if (addr)
+                {
+                    clearList(ptr);
+                    delete addr;
+                }
             }
         }
 
+        inline T* addr() const
+        {
+            return decode(this->_ptr);
+        }
+
         inline void setAddr(std::nullptr_t)
         {
             if (clearList(this->_ptr))
@@ -623,9 +1065,11 @@ namespace cmpsptr
                         clearList(this->_ptr);
                     }
                     this->_ptr = static_cast<uint32_t>(addr >> SHIFT_LEN);
+                    HeapMark::check(this->_ptr, ptr);
                 }
                 else
                 {
+                    HeapMark::check(4294967295U, ptr);
                     this->listPtr(ptr);
                 }
             }
@@ -641,33 +1085,24 @@ namespace cmpsptr
         {
             this->_ptr = 0U;
         }
-
-        inline ~BaseCmp<T, own, opt, level>()
-        {
-            if constexpr(own != 0)
-            {
-                auto ptr = this->addr();
-                if (ptr)
-                {
-                    clearList(this->_ptr);
-                    delete ptr;
-                }
-            }
-        }
 #else
 #define CMPS_LEVEL COMPRESS_POINTERS < -1 ? COMPRESS_POINTERS + 1 : 0
     template<typename T, const int own = 0, const int opt = -1, const int level = CMPS_LEVEL>
-    class BaseCmp : public BasePtr<T, BaseCmp<T, own, opt, level>, opt>
+    class BaseCmp : public BasePtr<T, BaseCmp<T, own, opt, level>, opt>,
+                    protected CmpsStore<BaseCmp<T, own, opt, level>, CmpsRaw<std::conditional_t<COMPRESS_POINTERS == 0, T*, uint32_t>>, own != 0>
     {
     #if COMPRESS_POINTERS == 0
-        static constexpr uint CmpsLengthShift(const int cmpsLevel)
+        static constexpr uint32_t CmpsLengthShift(const int cmpsLevel)
         {
             return cmpsLevel;
         }
 
-        T* _ptr;
-
     protected:
+        inline static T* decode(T* const ptr)
+        {
+            return ptr;
+        }
+
         inline void setAddr(T* const ptr)
         {
             this->_ptr = ptr;
@@ -689,7 +1124,7 @@ namespace cmpsptr
             this->setPntr(nullptr);
         }
     #else
-        static constexpr uint CmpsLengthShift(int cmpsLevel)
+        static constexpr uint32_t CmpsLengthShift(int cmpsLevel)
         {
             if (cmpsLevel < 0)
             {
@@ -704,12 +1139,15 @@ namespace cmpsptr
 #endif
         }
 
-        uint32_t _ptr;
-
     protected:
+        inline static T* decode(const uint32_t ptr)
+        {
+            return reinterpret_cast<T*>(static_cast<uintptr_t>(ptr) << SHIFT_LEN);
+        }
+
         inline T* addr() const
         {
-            return reinterpret_cast<T*>(static_cast<uintptr_t>(this->_ptr) << SHIFT_LEN);
+            return decode(this->_ptr);
         }
 
         inline void setAddr(std::nullptr_t)
@@ -722,6 +1160,7 @@ namespace cmpsptr
             //uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
             //assert(addr < (4294967295UL << SHIFT_LEN));
             this->_ptr = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(ptr) >> SHIFT_LEN);
+            HeapMark::check(this->_ptr, ptr);
         }
 
     public:
@@ -730,28 +1169,102 @@ namespace cmpsptr
             return true;
         }
 
-        inline BaseCmp<T, own, opt, level>() : _ptr(0U) {}
+        inline BaseCmp<T, own, opt, level>()
+        {
+            this->_ptr = 0U;
+        }
     #endif
-    public:
-        inline ~BaseCmp<T, own, opt, level>()
+    protected:
+        template <typename V>
+        inline static void dispose(const V ptr)
         {
-            if constexpr(own != 0)
-            {
-                auto ptr = this->addr();
-                if (ptr)
-                {
-                    delete ptr;
-                }
-            }
+            delete decode(ptr);
         }
 #endif
     protected:
         static constexpr int SHIFT_LEN = CmpsLengthShift(level);
 
-        inline void copy(const BaseCmp<T, own, opt, level>& cloned)
+    public:
+        static constexpr int shiftLen()
         {
-            static_assert(own < 1, "Attempting to clone unique pointer.");
-            this->_ptr = cloned._ptr;
+            return SHIFT_LEN;
+        }
+
+        static constexpr uintptr_t maxAddr()
+        {
+#if COMPRESS_POINTERS == 0
+            return UINTPTR_MAX;
+#elif COMPRESS_POINTERS > 0
+            return level == -1 ? 0U : (4294967295UL << SHIFT_LEN);
+#else
+            return 4294967295UL << SHIFT_LEN;
+#endif
+        }
+
+    protected:
+        /*
+        Publishes the candidate, if no address is stored yet, by a single compare-and-swap on the stored value, which is encoded in advance,
+        listing the candidate if needed; the thread losing the race releases the list slot of its candidate and returns the winner's target.
+        */
+        template<typename D>
+        T& initOnce(T* const ptr, D drop)
+        {
+            using V = decltype(this->_ptr);
+            static_assert(sizeof(std::atomic<V>) == sizeof(V) && std::atomic<V>::is_always_lock_free, "Stored values must be lock-free atomics.");
+            auto stored = reinterpret_cast<std::atomic<V>*>(&this->_ptr);
+            BaseCmp<T, own, opt, level> candidate;
+            candidate.setAddr(ptr);
+            V expected = V();
+            if (stored->compare_exchange_strong(expected, candidate._ptr, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                candidate._ptr = V();
+                return *ptr;
+            }
+            candidate.setAddr(nullptr);
+            drop(ptr);
+            return *decode(expected);
+        }
+
+    public:
+        /*
+        Thread-safe variant of refOrNew, which can be called concurrently on the same pointer: each thread finding it null constructs
+        a candidate, but only one of them is stored, the others being deleted, so that every caller gets a reference to the same object.
+        */
+        template<typename... Args, typename R = T&>
+        inline auto refOrNewOnce(Args&&... args) -> std::enable_if_t<(opt != 0 && opt > -2), R>
+        {
+            const auto ptr = reinterpret_cast<std::atomic<decltype(this->_ptr)>*>(&this->_ptr)->load(std::memory_order_acquire);
+            if (ptr)
+            {
+                return *decode(ptr);
+            }
+            return this->initOnce(new T(std::forward<Args>(args)...), [](T* const candidate) { delete candidate; });
+        }
+
+        /*
+        Thread-safe variant of refOrSet, storing the address of def only if no other address was stored before.
+        */
+        template<typename R = T&>
+        inline auto refOrSetOnce(T& def) -> std::enable_if_t<(opt != 0 && opt > -2 && own == 0), R>
+        {
+            const auto ptr = reinterpret_cast<std::atomic<decltype(this->_ptr)>*>(&this->_ptr)->load(std::memory_order_acquire);
+            if (ptr)
+            {
+                return *decode(ptr);
+            }
+            return this->initOnce(&def, [](T* const) {});
+        }
+
+    protected:
+
+        inline void copy(const BaseCmp<T, own, opt, level>& cloned)
+        {
+            static_assert(own < 1, "Attempting to clone unique pointer.");
+            if constexpr(own < 0)
+            {
+                dispose(this->_ptr);
+            }
+            this->_ptr = cloned._ptr;
             if constexpr(own < 0)
             {
                 const_cast<BaseCmp<T, own, opt, level>&>(cloned)._ptr = 0U;
@@ -760,6 +1273,10 @@ namespace cmpsptr
 
         inline void move(BaseCmp<T, own, opt, level>&& cloned)
         {
+            if constexpr(own != 0)
+            {
+                dispose(this->_ptr);
+            }
             this->_ptr = cloned._ptr;
             cloned._ptr = 0U;
         }
@@ -797,6 +1314,9 @@ namespace cmpsptr
         template <typename, typename, typename, const int> friend struct TckData;
         template <typename, typename, const int> friend struct ShrData;
         template <typename, class, const int> friend class BasePtr;
+        template <class, class, const bool> friend struct CmpsStore;
+        template <typename, const int> friend class CmpsBorrow;
+        friend struct CmpsOps;
 
     };
 
@@ -849,7 +1369,7 @@ namespace cmpsptr
     {
     private:
         BaseCmp<std::vector<BaseCmp<P, 0, 2, 9>>, 0, 2, 9> _weak_vct;
-        BaseCmp<QMutex, 0, 2, 9> _locker = new QMutex;
+        BaseCmp<CmpsMutex, 0, 2, 9> _locker = new CmpsMutex;
 
     protected:
         inline TckData<T, P, C, level>& countData()
@@ -862,7 +1382,7 @@ namespace cmpsptr
             return this->_weak_vct;
         }
 
-        inline BaseCmp<QMutex, 0, 2, 9>& lckDataRef()
+        inline BaseCmp<CmpsMutex, 0, 2, 9>& lckDataRef()
         {
             return this->_locker;
         }
@@ -872,10 +1392,10 @@ namespace cmpsptr
             auto locker = this->_locker.ptr();
             if (locker == nullptr)
             {
-                locker = new QMutex;
+                locker = new CmpsMutex;
                 this->_locker.setPtr(locker);
             }
-            auto uniqueLocker = QMutexLocker(locker);
+            auto uniqueLocker = CmpsLocker(locker);
             auto weakVct = this->_weak_vct.ptr();
             if (weakVct == nullptr)
             {
@@ -891,7 +1411,7 @@ namespace cmpsptr
             auto locker = this->_locker.ptr();
             if (locker)
             {
-                auto uniqueLocker = QMutexLocker(locker);
+                auto uniqueLocker = CmpsLocker(locker);
                 auto weakVct = this->_weak_vct.ptr();
                 if (weakVct)
                 {
@@ -915,7 +1435,7 @@ namespace cmpsptr
             auto locker = this->_locker.ptr();
             if (locker)
             {
-                auto uniqueLocker = QMutexLocker(locker);
+                auto uniqueLocker = CmpsLocker(locker);
                 auto weakVct = this->_weak_vct.ptr();
                 if (weakVct)
                 {
@@ -956,7 +1476,7 @@ namespace cmpsptr
             return this->countData().vctDataRef();
         }
 
-        inline BaseCmp<QMutex, 0, 2, 9>& lckDataRef()
+        inline BaseCmp<CmpsMutex, 0, 2, 9>& lckDataRef()
         {
             return this->countData().lckDataRef();
         }
@@ -996,751 +1516,3208 @@ namespace cmpsptr
         template <typename, class, const int> friend class BasePtr;
     };
 
-    template <typename T, const int cow = 0, const bool weak = false, const int opt = -1,
-              typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
-    class BaseCnt : public std::conditional_t<cow == 0, RefData<ShrData<T, C, level>, BaseCnt<T, 0, true, opt, C, level>, C, level>, ShrData<T, C, level>>,
-                    public BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>
+    /*
+    Workers are started on first use, each one owning a queue of tasks: tasks submitted by a worker are pushed to its own queue and taken
+    back in LIFO order, while idle workers steal the oldest tasks from the queues of the others. A parallel loop splits its range in chunks,
+    claimed through an atomic index by both the helper tasks and the calling thread, so nested loops cannot deadlock: the caller only waits
+    for chunks which have already been claimed, while helpers that start after the range has been exhausted simply return.
+    */
+    class TaskPool
     {
-        static_assert(cow < 1 || !weak, "Copy-on-write not allowed for weak references.");
-        //BaseCmp<C, 0, 2, 3> _ref_cnt;
-        //BaseCmp<T, 0, 2, level> _ptr;
-
     protected:
-        template<typename R = void>
-        inline auto increase() -> std::enable_if_t<(!weak), R>
+        struct Loop
         {
-            auto cnt = this->cntDataRef();
-            if (cnt)
+            std::atomic<std::size_t> next = 0U;
+            std::atomic<std::size_t> done = 0U;
+            std::size_t chunks;
+            std::size_t chunkSize;
+            std::size_t count;
+            std::function<void(const std::size_t, const std::size_t)> body;
+
+            void run()
             {
-                (*cnt) += 1U;
+                std::size_t chunk;
+                while ((chunk = this->next.fetch_add(1U, std::memory_order_relaxed)) < this->chunks)
+                {
+                    const std::size_t begin = chunk * this->chunkSize;
+                    const std::size_t end = begin + this->chunkSize;
+                    this->body(begin, end < this->count ? end : this->count);
+                    this->done.fetch_add(1U, std::memory_order_release);
+                }
             }
+        };
+
+        struct Queue
+        {
+            std::mutex locker;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::mutex _locker;
+        std::condition_variable _waiter;
+        std::deque<Queue> _queues;
+        std::vector<std::thread> _workers;
+        std::atomic<std::size_t> _pending = 0U;
+        std::atomic<std::size_t> _next_queue = 0U;
+        bool _stop = false;
+
+        inline static thread_local std::size_t _worker_idx = SIZE_MAX;
+        inline static std::atomic<std::size_t> _teardown = 0U;
+        inline static thread_local std::vector<std::function<void()>>* _retired = nullptr;
+
+        static TaskPool& global()
+        {
+            static TaskPool pool;
+            return pool;
         }
 
-        template<typename R = void>
-        inline auto decrease() -> std::enable_if_t<(!weak), R>
+        void push(std::function<void()>&& task)
         {
-            auto& tData = this->countData();
-            auto ptr = tData.ptrDataRef().addr();
-            if (ptr)
+            auto queueIdx = _worker_idx;
+            if (queueIdx == SIZE_MAX)
             {
-                if constexpr(cow == 0 && !weak) //tracking weak references
-                {
-                    this->nullify();
-                }
-                auto cnt = tData.cntDataRef().addr();
-                if (--(*cnt) == 0U)
-                {
-                    delete ptr;
-                    delete cnt;
-                }
+                queueIdx = this->_next_queue.fetch_add(1U, std::memory_order_relaxed) % this->_queues.size();
+            }
+            auto queue = &(this->_queues[queueIdx]);
+            {
+                auto uniqueLocker = std::unique_lock<std::mutex>(queue->locker);
+                queue->tasks.emplace_back(std::move(task));
+            }
+            this->_pending.fetch_add(1U, std::memory_order_release);
+            {
+                auto uniqueLocker = std::unique_lock<std::mutex>(this->_locker);
             }
+            this->_waiter.notify_one();
         }
 
-        inline T* addr() const
+        bool take(const std::size_t queueIdx, std::function<void()>& task)
         {
-            /*if constexpr(cow == 0 && weak) //tracking weak references
+            const std::size_t queueCount = this->_queues.size();
+            for (std::size_t i = 0U; i < queueCount; i += 1U)
             {
-                auto locker = tData.lckDataRef().ptr();
-                if (locker)
+                auto queue = &(this->_queues[(queueIdx + i) % queueCount]);
+                auto uniqueLocker = std::unique_lock<std::mutex>(queue->locker);
+                auto tasks = &queue->tasks;
+                if (!tasks->empty())
                 {
-                    auto uniqueLocker = QMutexLocker(locker);
-                    return tData.ptrDataRef().addr();
+                    if (i == 0U)
+                    {
+                        task = std::move(tasks->back());
+                        tasks->pop_back();
+                    }
+                    else
+                    {
+                        task = std::move(tasks->front());
+                        tasks->pop_front();
+                    }
+                    this->_pending.fetch_sub(1U, std::memory_order_relaxed);
+                    return true;
                 }
-            }*/
-            return const_cast<BaseCnt<T, cow, weak, opt, C, level>*>(this)->countData().ptrDataRef().addr();
+            }
+            return false;
         }
 
-        inline void setAddr(T* const ptr)
+        void work(const std::size_t queueIdx)
         {
-            auto& tData = this->countData();
-            tData.cntDataRef().setPntr(ptr ? new C(1U) : nullptr);
-            tData.ptrDataRef().setPntr(ptr);
+            _worker_idx = queueIdx;
+            std::function<void()> task;
+            for (;;)
+            {
+                if (this->take(queueIdx, task))
+                {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+                auto uniqueLocker = std::unique_lock<std::mutex>(this->_locker);
+                this->_waiter.wait(uniqueLocker, [this]() { return this->_stop || this->_pending.load(std::memory_order_acquire) > 0U; });
+                if (this->_stop && this->_pending.load(std::memory_order_acquire) == 0U)
+                {
+                    return;
+                }
+            }
         }
 
-        inline void copy(const BaseCnt<T, cow, weak, opt, C, level>& cloned)
+        inline TaskPool()
         {
-            if constexpr(!weak)
+            auto count = std::thread::hardware_concurrency();
+            count = count > 1U ? count - 1U : 1U;
+            for (unsigned int i = 0U; i < count; i += 1U)
             {
-                cloned.increase();
+                this->_queues.emplace_back();
             }
-            auto& tData = this->countData();
-            auto& cData = cloned.countData();
-            tData.cntDataRef() = cData.cntDataRef();
-            tData.ptrDataRef() = cData.ptrDataRef();
-            if constexpr(cow == 0) //tracking weak references
+            for (unsigned int i = 0U; i < count; i += 1U)
             {
-                tData.vctDataRef() = cData.vctDataRef();
-                tData.lckDataRef() = cData.lckDataRef();
+                this->_workers.emplace_back([this, i]() { this->work(i); });
             }
         }
 
-        inline void move(BaseCnt<T, cow, weak, opt, C, level>&& cloned)
+        inline ~TaskPool()
         {
-            this->copy(cloned);
-            auto& cData = cloned.countData();
-            if constexpr(cow == 0) //tracking weak references
             {
-                cData.vctDataRef()._ptr = 0U;
-                cData.lckDataRef()._ptr = 0U;
+                auto uniqueLocker = std::unique_lock<std::mutex>(this->_locker);
+                this->_stop = true;
+            }
+            this->_waiter.notify_all();
+            for (auto& worker : this->_workers)
+            {
+                worker.join();
             }
-            cData.cntDataRef()._ptr = 0U;
-            cData.ptrDataRef()._ptr = 0U;
         }
 
-        template<typename R = void>
-        inline auto setPntr(T* const ptr) -> std::enable_if_t<(!weak), R>
-        //inline void setPntr(T* const ptr)
+    public:
+        static std::size_t size()
         {
-            this->decrease();
-            this->setAddr(ptr);
+            return global()._workers.size();
         }
 
-    public:
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::BasePtr;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator*;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator->;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator();
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator bool;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator==;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator!=;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator>=;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator<=;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator>;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator<;
-        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator=;
-        //using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::setRef;
-
-        template<typename R = void>
-        inline auto detach(const bool always = true) const -> std::enable_if_t<(cow != 0 && !weak), R>
+        template<typename F>
+        static void parallelFor(const std::size_t count, std::size_t chunkSize, F&& body)
         {
-            auto& tData = this->countData();
-            auto ptr = tData.ptrDataRef().addr();
-            if (ptr)
+            if (chunkSize == 0U)
+            {
+                chunkSize = 1U;
+            }
+            const std::size_t chunks = (count + chunkSize - 1U) / chunkSize;
+            if (chunks < 2U)
             {
-                if (always || (*tData.cntDataRef()) > 1)
+                if (count)
                 {
-                    this->setPntr(new T(*ptr));
+                    body(static_cast<std::size_t>(0U), count);
                 }
+                return;
             }
-        }
-
-        template<typename R = std::conditional_t<weak, const BaseCnt<T, 0, false, opt, C, level>, const T*>>
-        inline auto ptr() const -> std::enable_if_t<(opt > 1), R>
-        {
-            if constexpr(weak)
+            auto& pool = global();
+            auto loop = std::make_shared<Loop>();
+            loop->chunks = chunks;
+            loop->chunkSize = chunkSize;
+            loop->count = count;
+            loop->body = std::forward<F>(body);
+            std::size_t helpers = pool._workers.size();
+            if (helpers > chunks - 1U)
             {
-                return *this;
+                helpers = chunks - 1U;
             }
-            else
+            for (std::size_t i = 0U; i < helpers; i += 1U)
             {
-                return this->addr();
+                pool.push([loop]() { loop->run(); });
+            }
+            loop->run();
+            while (loop->done.load(std::memory_order_acquire) < chunks)
+            {
+                std::this_thread::yield();
             }
         }
 
-        template<typename R = std::conditional_t<weak, BaseCnt<T, 0, false, opt, C, level>, T*>>
-        inline auto ptr() -> std::enable_if_t<(opt > 1), R>
+        /*
+        When the threshold is set to a positive value, arrays holding at least that many elements with non-trivial destructors are torn
+        down in parallel, each worker destroying a range of elements in place, before the storage is released once; counted objects
+        dropped while their owners are being deleted are retired level by level instead of recursively, splitting wide levels likewise.
+        */
+        inline static void setTeardown(const std::size_t threshold)
         {
-            if constexpr(weak)
+            _teardown.store(threshold, std::memory_order_relaxed);
+        }
+
+        inline static bool teardown(const std::size_t count)
+        {
+            const std::size_t threshold = _teardown.load(std::memory_order_relaxed);
+            return threshold > 0U && count >= threshold;
+        }
+
+        template<typename T>
+        static void teardown(T* const data, const std::size_t count)
+        {
+            const std::size_t chunkSize = count / (size() * 4U + 4U);
+            parallelFor(count, chunkSize < 64U ? 64U : chunkSize, [data](const std::size_t begin, const std::size_t end)
             {
-                return *this;
+                std::destroy(data + begin, data + end);
+            });
+        }
+
+        /*
+        Deletes an object whose last reference was dropped: any objects released by its destructor on the same thread are queued behind
+        it, rather than deleted from within, and the queue is then drained one level of the tree at a time, so deep chains do not exhaust
+        the stack and the levels reaching the teardown threshold are deleted by the workers, each of them draining its own subtrees.
+        */
+        template<typename F>
+        static void retire(F&& drop)
+        {
+            auto queued = _retired;
+            if (queued)
+            {
+                queued->emplace_back(std::forward<F>(drop));
+                return;
             }
-            else
+            if (_teardown.load(std::memory_order_relaxed) == 0U)
             {
-                if constexpr(cow > 0)
+                drop();
+                return;
+            }
+            std::vector<std::function<void()>> retired;
+            _retired = &retired;
+            drop();
+            while (!retired.empty())
+            {
+                std::vector<std::function<void()>> drops;
+                drops.swap(retired);
+                const std::size_t count = drops.size();
+                if (teardown(count))
                 {
-                    this->detach(false);
+                    parallelFor(count, count / (size() * 4U + 4U), [&drops](const std::size_t begin, const std::size_t end)
+                    {
+                        for (std::size_t i = begin; i < end; i += 1U)
+                        {
+                            drops[i]();
+                        }
+                    });
+                }
+                else
+                {
+                    for (auto& next : drops)
+                    {
+                        next();
+                    }
                 }
-                return this->countData().ptrDataRef().addr();
             }
+            _retired = nullptr;
         }
 
-        template<typename R = BaseCnt<T, 0, true, opt, C, level>>
-        inline auto weakRef() -> std::enable_if_t<(cow > 0 && !weak), R>
+        template<typename T>
+        static std::size_t chunkSize(const std::size_t count)
         {
-            if constexpr(cow == 0) //tracking weak references
-            {
-                BaseCnt<T, 0, true, opt, C, level> weakRef = *this;
-                this->track(weakRef);
-                return weakRef;
-            }
-            else
+            constexpr std::size_t lineSize = 64U;
+            constexpr std::size_t lineLen = sizeof(T) < lineSize ? lineSize / sizeof(T) : 1U;
+            std::size_t chunkSize = count / (size() * 8U + 8U);
+            if (chunkSize < lineLen * 64U)
             {
-                return *this;
+                chunkSize = lineLen * 64U;
             }
+            return ((chunkSize + lineLen - 1U) / lineLen) * lineLen;
         }
+    };
+#if !defined(CMPS_CHECK_BORROWS) && !defined(NDEBUG)
+    #define CMPS_CHECK_BORROWS 1
+#endif
+#ifdef CMPS_CHECK_BORROWS
+    /*
+    Registry of live borrows, counted by the stored values they share with the references they were taken from, which counted references
+    check when they release an object, or a pointer list slot, that borrows still depend on; only built when CMPS_CHECK_BORROWS is defined,
+    which is the default unless NDEBUG is defined.
+    */
+    class CmpsBorrows
+    {
+    protected:
+        inline static std::map<uintptr_t, uint32_t> _borrows;
+        inline static CmpsMutex _locker;
 
-        template<typename R = BaseCnt<T, 0, false, opt, C, level>>
-        inline auto sharedRef() -> std::enable_if_t<(weak), R>
+        inline static uintptr_t key(const uint32_t ptr)
         {
-            return *this;
+            return ptr;
         }
 
-        /*inline CmprShr(const BaseCmp<T, false, level>& cloned)
+        inline static uintptr_t key(const void* const ptr)
         {
-            this->setAddr(cloned.addr());
-        }*/
+            return reinterpret_cast<uintptr_t>(ptr);
+        }
 
-        inline BaseCnt<T, cow, weak, opt, C, level>()
+        template <typename V>
+        static void enter(const V ptr)
         {
-            this->setAddr(nullptr);
+            if (ptr)
+            {
+                auto uniqueLocker = CmpsLocker(&CmpsBorrows::_locker);
+                _borrows[key(ptr)] += 1U;
+            }
         }
 
-        inline ~BaseCnt<T, cow, weak, opt, C, level>()
+        template <typename V>
+        static void leave(const V ptr)
         {
-            if constexpr(weak)
+            if (ptr)
             {
-                if constexpr(cow == 0) //tracking weak references
+                auto uniqueLocker = CmpsLocker(&CmpsBorrows::_locker);
+                auto itr = _borrows.find(key(ptr));
+                if (itr != _borrows.end() && (--(itr->second)) == 0U)
                 {
-                    this->untrack(this);
+                    _borrows.erase(itr);
                 }
             }
-            else
+        }
+
+        template <typename V>
+        static void release(const V ptr)
+        {
+            auto uniqueLocker = CmpsLocker(&CmpsBorrows::_locker);
+            assert(_borrows.find(key(ptr)) == _borrows.end() && "Counted reference released while still borrowed.");
+        }
+
+    public:
+        static std::size_t size()
+        {
+            auto uniqueLocker = CmpsLocker(&CmpsBorrows::_locker);
+            std::size_t size = 0U;
+            for (const auto& borrow : _borrows)
             {
-                this->decrease();
+                size += borrow.second;
             }
+            return size;
         }
 
-        template <typename, typename, const int> friend struct ShrData;
-        template<typename, typename, typename L, const L, const bool> friend class BaseVct;
-        template <typename, typename, typename, const int> friend struct TckData;
-        template <typename, class, const int> friend class BasePtr;
+        template <typename, const int> friend class CmpsBorrow;
+        template <typename, const int, const bool, const int, typename, const int> friend class BaseCnt;
     };
-
-    /*template <typename T, const int cow = 0, const bool weak = false, const int opt = -1,
-              typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
-    class BaseShr : public BasePtr<T, BaseShr<T, cow, weak, opt, C, level>, weak ? -2 : opt>
+#endif
+    template <typename T, const int level> class CmpsBorrow;
+
+    /*
+    Objects declaring public increase(), decrease() and refCount() members, where decrease() returns true when the last reference was
+    dropped, are counted intrusively by strong CmpsCnt references, unless weak references are tracked (cow == 0); such references hold
+    a single compressed pointer, while increasing their counter touches the object itself, instead of a separately allocated one.
+    */
+    template <typename T, typename = void>
+    struct CmpsIntrusive : std::false_type {};
+
+    template <typename T>
+    struct CmpsIntrusive<T, std::void_t<decltype(std::declval<T&>().increase()), decltype(std::declval<const T&>().refCount()),
+                                        std::enable_if_t<std::is_convertible_v<decltype(std::declval<T&>().decrease()), bool>>>> : std::true_type {};
+
+    /*
+    Base of intrusively counted objects, embedding their counter; counts start from zero, each counted reference increasing it, and are
+    not copied along with the objects, so that copies made by copy-on-write references get their own.
+    */
+    template <typename T, typename C = std::atomic<uint32_t>>
+    class CmpsRefCounted
     {
-        BaseCmp<BaseCnt<T, cow, weak, opt, C, level>, 1, 2, 9> _shr_ref;
+        C _ref_cnt {0U};
 
     public:
-        template <typename, class, const int> friend class BasePtr;
-    };*/
+        inline uint32_t refCount() const
+        {
+            return static_cast<uint32_t>(this->_ref_cnt);
+        }
 
-}
+        inline void increase()
+        {
+            this->_ref_cnt += 1U;
+        }
 
-#if ALIGN_POINTERS
-    #ifdef Q_OS_WINDOWS
-inline void* alloc(const std::size_t size)
-{
-    return _aligned_malloc(size, ALIGN_POINTERS);
-}
+        inline bool decrease()
+        {
+            return (--(this->_ref_cnt)) == 0U;
+        }
 
-inline void clear(void* ptr) noexcept
-{
-    _aligned_free(ptr);
-}
-    #else
-inline void clear(void* ptr) noexcept
-{
-    free(ptr);
-}
-        #ifdef Q_OS_ANDROID
-inline void* alloc(const std::size_t size)
-{
-    void* ptr;
+        inline CmpsRefCounted<T, C>& operator=(const CmpsRefCounted<T, C>&)
+        {
+            return *this;
+        }
+
+        inline CmpsRefCounted<T, C>(const CmpsRefCounted<T, C>&) {}
+
+        inline CmpsRefCounted<T, C>() {}
+    };
+
+    template <typename T, const int level>
+    struct IntData
+    {
+    private:
+        BaseCmp<T, 0, 2, level> _ptr;
+
+    protected:
+        inline IntData<T, level>& countData()
+        {
+            return *this;
+        }
+
+        inline BaseCmp<T, 0, 2, level>& ptrDataRef()
+        {
+            return this->_ptr;
+        }
+
+        template <typename, class, const int> friend class BasePtr;
+        template <typename, const int, const bool, const int, typename, const int> friend class BaseCnt;
+    };
+
+    template <typename T, const int cow = 0, const bool weak = false, const int opt = -1,
+              typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
+    class BaseCnt : public std::conditional_t<cow != 0 && !weak && CmpsIntrusive<T>::value, IntData<T, level>,
+                                              std::conditional_t<cow == 0, RefData<ShrData<T, C, level>, BaseCnt<T, 0, true, opt, C, level>, C, level>, ShrData<T, C, level>>>,
+                    public BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>
+    {
+        static_assert(cow < 1 || !weak, "Copy-on-write not allowed for weak references.");
+        static constexpr bool intrusive = cow != 0 && !weak && CmpsIntrusive<T>::value;
+        //BaseCmp<C, 0, 2, 3> _ref_cnt;
+        //BaseCmp<T, 0, 2, level> _ptr;
+
+    protected:
+        template<typename R = void>
+        inline auto increase() const -> std::enable_if_t<(!weak), R>
+        {
+            if constexpr(intrusive)
+            {
+                auto ptr = this->addr();
+                if (ptr)
+                {
+                    ptr->increase();
+                }
+            }
+            else
+            {
+                auto cnt = const_cast<BaseCnt<T, cow, weak, opt, C, level>*>(this)->countData().cntDataRef().addr();
+                if (cnt)
+                {
+                    (*cnt) += 1U;
+                }
+            }
+        }
+
+        /*
+        Drops the reference held by this instance, deleting the object and its counter along with the last one; the stored addresses
+        are reset afterwards, so that the slots they might occupy in the pointer list are released, as they are not shared with copies.
+        */
+        template<typename R = void>
+        inline auto decrease() -> std::enable_if_t<(!weak), R>
+        {
+            auto& tData = this->countData();
+            auto ptr = tData.ptrDataRef().addr();
+            if (ptr)
+            {
+                C* cnt = nullptr;
+                bool last;
+                if constexpr(intrusive)
+                {
+                    last = ptr->decrease();
+                }
+                else
+                {
+                    cnt = tData.cntDataRef().addr();
+                    last = --(*cnt) == 0U;
+                }
+                if (last)
+                {
+#ifdef CMPS_CHECK_BORROWS
+                    CmpsBorrows::release(tData.ptrDataRef()._ptr);
+#endif
+                    if constexpr(cow == 0 && !weak) //tracking weak references
+                    {
+                        this->nullify();
+                    }
+                    TaskPool::retire([ptr, cnt]()
+                    {
+                        delete ptr;
+                        delete cnt;
+                    });
+                }
+#if defined(CMPS_CHECK_BORROWS) && COMPRESS_POINTERS > 0
+                else if (!tData.ptrDataRef().comrpessed())
+                {
+                    CmpsBorrows::release(tData.ptrDataRef()._ptr);
+                }
+#endif
+                if constexpr(!intrusive)
+                {
+                    tData.cntDataRef().setPntr(nullptr);
+                }
+                tData.ptrDataRef().setPntr(nullptr);
+            }
+        }
+
+        inline T* addr() const
+        {
+            /*if constexpr(cow == 0 && weak) //tracking weak references
+            {
+                auto locker = tData.lckDataRef().ptr();
+                if (locker)
+                {
+                    auto uniqueLocker = CmpsLocker(locker);
+                    return tData.ptrDataRef().addr();
+                }
+            }*/
+            return const_cast<BaseCnt<T, cow, weak, opt, C, level>*>(this)->countData().ptrDataRef().addr();
+        }
+
+        inline void setAddr(T* const ptr)
+        {
+            auto& tData = this->countData();
+            if constexpr(intrusive)
+            {
+                if (ptr)
+                {
+                    ptr->increase();
+                }
+            }
+            else
+            {
+                tData.cntDataRef().setPntr(ptr ? new C(1U) : nullptr);
+            }
+            tData.ptrDataRef().setPntr(ptr);
+        }
+
+        inline void copy(const BaseCnt<T, cow, weak, opt, C, level>& cloned)
+        {
+            if constexpr(!weak)
+            {
+                cloned.increase();
+                this->decrease();
+            }
+            auto& tData = this->countData();
+            auto& cData = const_cast<BaseCnt<T, cow, weak, opt, C, level>&>(cloned).countData();
+            if constexpr(!intrusive)
+            {
+                tData.cntDataRef().setPntr(cData.cntDataRef().addr());
+            }
+            tData.ptrDataRef().setPntr(cData.ptrDataRef().addr());
+            if constexpr(cow == 0) //tracking weak references
+            {
+                tData.vctDataRef() = cData.vctDataRef();
+                tData.lckDataRef() = cData.lckDataRef();
+            }
+        }
+
+        inline void move(BaseCnt<T, cow, weak, opt, C, level>&& cloned)
+        {
+            if constexpr(!weak)
+            {
+                this->decrease();
+            }
+            auto& tData = this->countData();
+            auto& cData = cloned.countData();
+            if constexpr(!intrusive)
+            {
+                tData.cntDataRef().setPntr(nullptr);
+                tData.cntDataRef()._ptr = cData.cntDataRef()._ptr;
+                cData.cntDataRef()._ptr = 0U;
+            }
+            tData.ptrDataRef().setPntr(nullptr);
+            tData.ptrDataRef()._ptr = cData.ptrDataRef()._ptr;
+            if constexpr(cow == 0) //tracking weak references
+            {
+                tData.vctDataRef() = cData.vctDataRef();
+                tData.lckDataRef() = cData.lckDataRef();
+                cData.vctDataRef()._ptr = 0U;
+                cData.lckDataRef()._ptr = 0U;
+            }
+            cData.ptrDataRef()._ptr = 0U;
+        }
+
+        template<typename R = void>
+        inline auto setPntr(T* const ptr) -> std::enable_if_t<(!weak), R>
+        //inline void setPntr(T* const ptr)
+        {
+            this->decrease();
+            this->setAddr(ptr);
+        }
+
+    public:
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::BasePtr;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator*;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator->;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator();
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator bool;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator==;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator!=;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator>=;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator<=;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator>;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator<;
+        using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::operator=;
+        //using BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>::setRef;
+
+        template<typename R = void>
+        inline auto detach(const bool always = true) -> std::enable_if_t<(cow != 0 && !weak), R>
+        {
+            auto& tData = this->countData();
+            auto ptr = tData.ptrDataRef().addr();
+            if (ptr)
+            {
+                if (always || this->refCount() > 1U)
+                {
+                    this->setPntr(new T(*ptr));
+                }
+            }
+        }
+
+        template<typename R = std::conditional_t<weak, const BaseCnt<T, 0, false, opt, C, level>, const T*>>
+        inline auto ptr() const -> std::enable_if_t<(opt > 1), R>
+        {
+            if constexpr(weak)
+            {
+                return *this;
+            }
+            else
+            {
+                return this->addr();
+            }
+        }
+
+        template<typename R = std::conditional_t<weak, BaseCnt<T, 0, false, opt, C, level>, T*>>
+        inline auto ptr() -> std::enable_if_t<(opt > 1), R>
+        {
+            if constexpr(weak)
+            {
+                return *this;
+            }
+            else
+            {
+                if constexpr(cow > 0)
+                {
+                    this->detach(false);
+                }
+                return this->countData().ptrDataRef().addr();
+            }
+        }
+
+        template<typename R = BaseCnt<T, 0, true, opt, C, level>>
+        inline auto weakRef() -> std::enable_if_t<(cow > 0 && !weak), R>
+        {
+            if constexpr(cow == 0) //tracking weak references
+            {
+                BaseCnt<T, 0, true, opt, C, level> weakRef = *this;
+                this->track(weakRef);
+                return weakRef;
+            }
+            else
+            {
+                return *this;
+            }
+        }
+
+        template<typename R = BaseCnt<T, 0, false, opt, C, level>>
+        inline auto sharedRef() -> std::enable_if_t<(weak), R>
+        {
+            return *this;
+        }
+
+        template<typename R = uint32_t>
+        inline auto refCount() const -> std::enable_if_t<(!weak), R>
+        {
+            if constexpr(intrusive)
+            {
+                auto ptr = this->addr();
+                return ptr ? ptr->refCount() : 0U;
+            }
+            else
+            {
+                auto cnt = const_cast<BaseCnt<T, cow, weak, opt, C, level>*>(this)->countData().cntDataRef().addr();
+                return cnt ? static_cast<uint32_t>(*cnt) : 0U;
+            }
+        }
+
+        template<typename R = CmpsBorrow<T, level>>
+        inline auto borrow() const -> std::enable_if_t<(!weak), R>
+        {
+            return R(const_cast<BaseCnt<T, cow, weak, opt, C, level>*>(this)->countData().ptrDataRef()._ptr);
+        }
+
+        /*inline CmprShr(const BaseCmp<T, false, level>& cloned)
+        {
+            this->setAddr(cloned.addr());
+        }*/
+
+        inline BaseCnt<T, cow, weak, opt, C, level>()
+        {
+            this->setAddr(nullptr);
+        }
+
+        inline BaseCnt<T, cow, weak, opt, C, level>(const BaseCnt<T, cow, weak, opt, C, level>& cloned)
+            : BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>(cloned) {}
+
+        inline BaseCnt<T, cow, weak, opt, C, level>(BaseCnt<T, cow, weak, opt, C, level>&& cloned) noexcept
+            : BasePtr<T, BaseCnt<T, cow, weak, opt, C, level>, weak ? -2 : opt>(std::move(cloned)) {}
+
+        inline BaseCnt<T, cow, weak, opt, C, level>& operator=(const BaseCnt<T, cow, weak, opt, C, level>& cloned)
+        {
+            if (this != &cloned)
+            {
+                this->copy(cloned);
+            }
+            return *this;
+        }
+
+        inline BaseCnt<T, cow, weak, opt, C, level>& operator=(BaseCnt<T, cow, weak, opt, C, level>&& cloned)
+        {
+            if (this != &cloned)
+            {
+                this->move(std::move(cloned));
+            }
+            return *this;
+        }
+
+        inline ~BaseCnt()
+        {
+            if constexpr(weak)
+            {
+                if constexpr(cow == 0) //tracking weak references
+                {
+                    this->untrack(this);
+                }
+            }
+            else
+            {
+                this->decrease();
+            }
+        }
+
+        template <typename, typename, const int> friend struct ShrData;
+        template<typename, typename, typename L, const L, const bool> friend class BaseVct;
+        template <typename, typename, typename, const int> friend struct TckData;
+        template <typename, class, const int> friend class BasePtr;
+    };
+
+    /*
+    Non-owning view of the object shared by a counted reference, holding only the stored value of its compressed address, so that borrows
+    can be passed along read-only call chains, instead of counted copies, without any atomic operations or allocations. Borrows share the
+    pointer list slot of the reference they were taken from, so they must not outlive it; when CMPS_CHECK_BORROWS is defined, references
+    assert that they are not borrowed anymore when they release their object or their slot.
+    */
+    template <typename T, const int level = CMPS_LEVEL>
+    class CmpsBorrow
+    {
+    protected:
+        using Ptr = BaseCmp<T, 0, 2, level>;
+        using V = std::conditional_t<COMPRESS_POINTERS == 0, T*, uint32_t>;
+
+        V _ptr;
+
+        inline explicit CmpsBorrow<T, level>(const V ptr) : _ptr(ptr)
+        {
+#ifdef CMPS_CHECK_BORROWS
+            CmpsBorrows::enter(ptr);
+#endif
+        }
+
+    public:
+        inline T* ptr() const
+        {
+            return Ptr::decode(this->_ptr);
+        }
+
+        inline T* operator->() const
+        {
+            return this->ptr();
+        }
+
+        inline T& operator*() const
+        {
+            return *this->ptr();
+        }
+
+        inline explicit operator bool() const
+        {
+            return this->_ptr != V();
+        }
+
+        inline bool operator==(const CmpsBorrow<T, level>& other) const
+        {
+            return this->ptr() == other.ptr();
+        }
+
+        inline bool operator!=(const CmpsBorrow<T, level>& other) const
+        {
+            return this->ptr() != other.ptr();
+        }
+
+        template <const int cow, const int opt, typename C>
+        inline CmpsBorrow<T, level>(const BaseCnt<T, cow, false, opt, C, level>& shared) : CmpsBorrow<T, level>(shared.borrow()) {}
+
+        inline CmpsBorrow<T, level>() : _ptr(V()) {}
+#ifdef CMPS_CHECK_BORROWS
+        inline CmpsBorrow<T, level>(const CmpsBorrow<T, level>& other) : CmpsBorrow<T, level>(other._ptr) {}
+
+        inline CmpsBorrow<T, level>& operator=(const CmpsBorrow<T, level>& other)
+        {
+            CmpsBorrows::enter(other._ptr);
+            CmpsBorrows::leave(this->_ptr);
+            this->_ptr = other._ptr;
+            return *this;
+        }
+
+        inline ~CmpsBorrow()
+        {
+            CmpsBorrows::leave(this->_ptr);
+        }
+#endif
+
+        template <typename, const int, const bool, const int, typename, const int> friend class BaseCnt;
+    };
+
+    /*
+    Reference counter which can be used as the C parameter of counted references, behaving as a single atomic until its compare-and-swap
+    operations fail CONFLICTS times, then inflating to stripes, one per thread slot, on separate cache lines, so that copies made by many
+    threads at once do not contend for the same line. The stripes are the leaves of a scalable non-zero indicator (SNZI): the low half of
+    the central word counts direct references, while its high half counts the stripes holding references, which a stripe increases when
+    it becomes non-empty and decreases when it becomes empty again, with a transient half state resolving concurrent first arrivals; the
+    counter therefore reaches zero exactly when the central word does. References are released from the stripe of the current thread,
+    or else from any stripe, or else from the direct count, since they are interchangeable; the count read from it is only a snapshot.
+    */
+    class CmpsStripedCount
+    {
+    protected:
+        static constexpr uint32_t CONFLICTS = 64U;
+        static constexpr uint32_t MAX_STRIPES = 64U;
+        static constexpr uint64_t LOW_MASK = 4294967295ULL;
+        static constexpr uint64_t STRIPE_UNIT = 1ULL << 32;
+
+        struct alignas(64) Stripe
+        {
+            std::atomic<uint64_t> leaf {0U};
+        };
+
+        std::atomic<uint64_t> _count;
+        std::atomic<uint32_t> _conflicts {0U};
+        std::atomic<Stripe*> _stripes {nullptr};
+        inline static std::atomic<uint32_t> _next_slot {0U};
+        inline static thread_local uint32_t _slot = UINT32_MAX;
+
+        inline static uint32_t stripeCount()
+        {
+            static const uint32_t count = []()
+            {
+                const uint32_t threads = std::thread::hardware_concurrency();
+                uint32_t count = 2U;
+                while (count < threads && count < MAX_STRIPES)
+                {
+                    count <<= 1;
+                }
+                return count;
+            }();
+            return count;
+        }
+
+        inline static uint32_t slot()
+        {
+            if (_slot == UINT32_MAX)
+            {
+                _slot = _next_slot.fetch_add(1U, std::memory_order_relaxed);
+            }
+            return _slot & (stripeCount() - 1U);
+        }
+
+        void conflict()
+        {
+            if (this->_conflicts.fetch_add(1U, std::memory_order_relaxed) + 1U == CONFLICTS)
+            {
+                auto stripes = new Stripe[stripeCount()];
+                Stripe* expected = nullptr;
+                if (!this->_stripes.compare_exchange_strong(expected, stripes))
+                {
+                    delete[] stripes;
+                }
+            }
+        }
+
+        /*
+        Arrival at a stripe, following the SNZI protocol: leaves hold twice their count in their low half and a version in their high
+        half, 1 marking the half state of a first arrival, which increases the central word before the leaf becomes 2, any thread seeing
+        it helping by doing the same, while the arrivals which fail to complete the transition undo their increase afterwards.
+        */
+        void arrive(std::atomic<uint64_t>& leaf)
+        {
+            uint32_t undo = 0U;
+            bool done = false;
+            while (!done)
+            {
+                uint64_t value = leaf.load();
+                uint64_t count = value & LOW_MASK;
+                if (count > 1U)
+                {
+                    done = leaf.compare_exchange_weak(value, value + 2U);
+                    continue;
+                }
+                if (count == 0U)
+                {
+                    const uint64_t half = ((value & ~LOW_MASK) + STRIPE_UNIT) | 1U;
+                    if (leaf.compare_exchange_strong(value, half))
+                    {
+                        done = true;
+                        value = half;
+                        count = 1U;
+                    }
+                }
+                if (count == 1U)
+                {
+                    this->_count.fetch_add(STRIPE_UNIT);
+                    if (!leaf.compare_exchange_strong(value, (value & ~LOW_MASK) | 2U))
+                    {
+                        undo += 1U;
+                    }
+                }
+            }
+            if (undo > 0U)
+            {
+                this->_count.fetch_sub(undo * STRIPE_UNIT);
+            }
+        }
+
+        /*
+        Releases a reference held by the stripe, returning 0 if it was empty, 1 if a reference was released, or 2 if it was the last one.
+        */
+        int depart(std::atomic<uint64_t>& leaf)
+        {
+            uint64_t value = leaf.load();
+            while ((value & LOW_MASK) > 1U)
+            {
+                if (leaf.compare_exchange_weak(value, value - 2U))
+                {
+                    if ((value & LOW_MASK) == 2U)
+                    {
+                        return this->_count.fetch_sub(STRIPE_UNIT) == STRIPE_UNIT ? 2 : 1;
+                    }
+                    return 1;
+                }
+            }
+            return 0;
+        }
+
+    public:
+        CmpsStripedCount& operator+=(uint32_t count)
+        {
+            auto stripes = this->_stripes.load();
+            if (stripes)
+            {
+                auto& leaf = stripes[slot()].leaf;
+                for (; count > 0U; count -= 1U)
+                {
+                    this->arrive(leaf);
+                }
+                return *this;
+            }
+            uint64_t value = this->_count.load(std::memory_order_relaxed);
+            if (!this->_count.compare_exchange_strong(value, value + count, std::memory_order_relaxed))
+            {
+                this->conflict();
+                this->_count.fetch_add(count, std::memory_order_relaxed);
+            }
+            return *this;
+        }
+
+        /*
+        Releases a reference, returning zero only if it was the last one.
+        */
+        uint32_t operator--()
+        {
+            for (;;)
+            {
+                auto stripes = this->_stripes.load();
+                if (stripes)
+                {
+                    const uint32_t stripeCnt = stripeCount(), first = slot();
+                    for (uint32_t i = 0U; i < stripeCnt; i += 1U)
+                    {
+                        const int departed = this->depart(stripes[(first + i) & (stripeCnt - 1U)].leaf);
+                        if (departed > 0)
+                        {
+                            return departed == 2 ? 0U : 1U;
+                        }
+                    }
+                }
+                uint64_t value = this->_count.load();
+                while ((value & LOW_MASK) > 0U)
+                {
+                    if (this->_count.compare_exchange_weak(value, value - 1U))
+                    {
+                        return value == 1U ? 0U : 1U;
+                    }
+                    else if (stripes == nullptr)
+                    {
+                        this->conflict();
+                    }
+                }
+            }
+        }
+
+        operator uint32_t() const
+        {
+            uint64_t count = this->_count.load() & LOW_MASK;
+            auto stripes = this->_stripes.load();
+            if (stripes)
+            {
+                const uint32_t stripeCnt = stripeCount();
+                for (uint32_t i = 0U; i < stripeCnt; i += 1U)
+                {
+                    count += (stripes[i].leaf.load() & LOW_MASK) >> 1;
+                }
+            }
+            return static_cast<uint32_t>(count);
+        }
+
+        inline bool inflated() const
+        {
+            return this->_stripes.load() != nullptr;
+        }
+
+        inline CmpsStripedCount& operator=(const CmpsStripedCount&) = delete;
+        inline CmpsStripedCount(const CmpsStripedCount&) = delete;
+
+        inline CmpsStripedCount(const uint32_t count = 0U) : _count(count) {}
+
+        inline ~CmpsStripedCount()
+        {
+            delete[] this->_stripes.load();
+        }
+    };
+
+    /*template <typename T, const int cow = 0, const bool weak = false, const int opt = -1,
+              typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
+    class BaseShr : public BasePtr<T, BaseShr<T, cow, weak, opt, C, level>, weak ? -2 : opt>
+    {
+        BaseCmp<BaseCnt<T, cow, weak, opt, C, level>, 1, 2, 9> _shr_ref;
+
+    public:
+        template <typename, class, const int> friend class BasePtr;
+    };*/
+
+}
+
+#if ALIGN_POINTERS
+    #ifdef CMPS_OS_WINDOWS
+inline void* alloc(const std::size_t size)
+{
+    return _aligned_malloc(size, ALIGN_POINTERS);
+}
+
+inline void clear(void* ptr) noexcept
+{
+    _aligned_free(ptr);
+}
+    #else
+inline void clear(void* ptr) noexcept
+{
+    free(ptr);
+}
+        #ifdef CMPS_OS_ANDROID
+inline void* alloc(const std::size_t size)
+{
+    void* ptr;
     posix_memalign(&ptr, ALIGN_POINTERS, size);
     return ptr;
 }
-        #else
+        #else
+inline void* alloc(const std::size_t size)
+{
+    return std::aligned_alloc(ALIGN_POINTERS, size);
+}
+        #endif
+    #endif
+inline void* operator new(const std::size_t size, std::nothrow_t)
+{
+    return alloc(size);
+}
+
+void* operator new(const std::size_t size)
+{
+    auto ptr = alloc(size);
+    if (ptr)
+    {
+        return ptr;
+    }
+    else
+    {
+        throw std::bad_alloc {};
+    }
+}
+
+void operator delete(void* ptr) noexcept
+{
+    clear(ptr);
+}
+#else
 inline void* alloc(const std::size_t size)
 {
-    return std::aligned_alloc(ALIGN_POINTERS, size);
+    return std::malloc(size);
 }
-        #endif
-    #endif
-inline void* operator new(const std::size_t size, std::nothrow_t)
+
+inline void clear(void* ptr) noexcept
 {
-    return alloc(size);
+    free(ptr);
 }
+#endif
+
+namespace cmpsptr
+{
+
+    /*
+    Types which can be moved to another address by copying their bytes, after which the source can be left as all-zero bits, whose
+    destruction does nothing; compressed pointers do not refer to themselves, so this holds for them, except for counted references
+    tracking weak ones, which are registered by address and allocate their tracking block when constructed.
+    */
+    template <typename T>
+    struct CmpsRelocatable : std::is_trivially_copyable<T> {};
+
+    template <typename P>
+    struct FixData
+    {
+        P _data;
+
+        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
+    };
+
+    template <typename P, typename L>
+    struct VarData : public FixData<P>
+    {
+        L _init: 1;
+        L _length: (sizeof(L) * 8) - 1;
+
+        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
+    };
+
+    template<typename T, typename P = BaseCmp<T>, typename L = uint32_t, const L fixedSize = 0, const bool dispose = fixedSize < 1>
+    class BaseVct : protected std::conditional_t<fixedSize < 1, VarData<P, L>, FixData<P>>
+    {
+
+    protected:
+        inline BaseVct<T, P, L, fixedSize, dispose>(T* beginPtr, const L size, const bool own)
+        {
+            assert(fixedSize < 1 || size <= fixedSize);
+            this->_data = beginPtr;
+            if constexpr(fixedSize < 1)
+            {
+                this->_length = size;
+                this->_init = own;
+            }
+        }
+
+        inline void clear()
+        {
+            if constexpr(dispose || fixedSize < 1)
+            {
+               if constexpr(fixedSize < 1)
+               {
+                   if (!this->init())
+                   {
+                       return;
+                   }
+               }
+               auto ptr = this->_data.addr();
+               if (ptr)
+               {
+                   this->_data.setPntr(nullptr);
+                   release(ptr, this->size());
+               }
+            }
+        }
+
+        inline static void release(T* const ptr, const std::size_t size)
+        {
+            if constexpr(!std::is_trivially_destructible<T>::value)
+            {
+                if (TaskPool::teardown(size))
+                {
+                    TaskPool::teardown(ptr, size);
+                }
+                else
+                {
+                    std::destroy_n(ptr, size);
+                }
+            }
+            ::clear(const_cast<void*>(static_cast<const void*>(ptr)));
+        }
+
+        inline T& from(const L index) const
+        {
+            return const_cast<BaseVct*>(this)->_data.addr()[index];
+        }
+
+        inline void copy(const BaseVct<T, P, L, 0, true>& copy)
+        {
+            if constexpr(fixedSize < 1)
+            {
+                auto size = copy.size();
+                assert(fixedSize < 1 || fixedSize < size);
+                this->_length = size;
+                this->_init = false;
+            }
+            this->_data = copy._data;
+        }
+
+        inline void copy(const BaseVct<T, P, L, fixedSize, false>& copy)
+        {
+            if constexpr(fixedSize < 1)
+            {
+                this->_length = copy.size();
+                this->_init = false;
+            }
+            this->_data = copy._data;
+        }
+
+        inline bool init() const
+        {
+            if constexpr(fixedSize < 1)
+            {
+                if (this == nullptr)
+                {
+                    return false;
+                }
+                return this->_init;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+    public:
+        /*
+        Allocates raw storage for the elements and default constructs them in place, returning null when out of memory; arrays handed to
+        adopt() have to come from here, since they are released by destroying each element once and freeing the storage.
+        */
+        inline static T* allocate(const std::size_t size)
+        {
+            using E = typename std::remove_const<T>::type;
+            auto data = static_cast<E*>(::alloc(size * sizeof(T)));
+            if (data)
+            {
+                try
+                {
+                    std::uninitialized_default_construct_n(data, size);
+                }
+                catch (...)
+                {
+                    ::clear(static_cast<void*>(data));
+                    throw;
+                }
+            }
+            return data;
+        }
+
+        /*
+        Creates a vector owning storage returned by allocate(), which it releases when cleared or destroyed.
+        */
+        inline static BaseVct<T, P, L, fixedSize, dispose> adopt(T* const data, const L size = fixedSize)
+        {
+            return BaseVct<T, P, L, fixedSize, dispose>(data, size, true);
+        }
+
+        inline T* begin()
+        {
+            return this->_data.addr();
+        }
+
+        inline T* end()
+        {
+            return this->_data.addr() + this->size();
+        }
+
+        inline const T* cbegin() const
+        {
+            return this->_data.addr();
+        }
+
+        inline const T* cend() const
+        {
+            return this->_data.addr() + this->size();
+        }
+
+        inline T* begin() const
+        {
+            return this->_data.addr();
+        }
+
+        inline T* end() const
+        {
+            return this->_data.addr() + this->size();
+        }
+
+        inline const L size() const
+        {
+            if constexpr(fixedSize < 1)
+            {
+                return this->_length;
+            }
+            else
+            {
+                return fixedSize;
+            }
+        }
+
+        inline const T& at(const L index) const
+        {
+            return const_cast<BaseVct*>(this)->from(index);
+        }
+
+        bool contains(const T& comp) const
+        {
+            const auto size = this->size();
+            for (L i = 0U; i < size; i += 1)
+            {
+                if (this->at(i) == comp)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        L indexOf(const T& comp) const
+        {
+            const auto size = this->size();
+            for (L i = 0U; i < size; i += 1)
+            {
+               if (this->at(i) == comp)
+               {
+                   return i;
+               }
+            }
+            return size; //TODO: analyze if something better can be done for unsigned values;
+        }
+
+        template<typename R = bool>
+        //template<typename R = bool, typename... Args>
+        //auto resize(const L nSize, Args&&... args) -> std::enable_if_t<(fixedSize < 1), R>
+        auto resize(const L nSize) -> std::enable_if_t<(fixedSize < 1), R>
+        {
+            T* nArr = allocate(nSize); //{ T(std::forward<Args>(args)...) };
+            if (nArr == nullptr)
+            {
+                return false;
+            }
+            const auto oSize = this->size();
+            if constexpr(std::is_trivially_copyable<T>::value)
+            {
+                if (oSize > 0U)
+                {
+                    std::memcpy(static_cast<void*>(nArr), this->_data.addr(), (oSize < nSize ? oSize : nSize) * sizeof(T));
+                }
+            }
+            else if constexpr(CmpsRelocatable<T>::value)
+            {
+                if (oSize > 0U)
+                {
+                    const std::size_t count = (oSize < nSize ? oSize : nSize) * sizeof(T);
+                    auto oArr = static_cast<void*>(this->_data.addr());
+                    std::memcpy(static_cast<void*>(nArr), oArr, count);
+                    std::memset(oArr, 0, count);
+                }
+            }
+            else
+            {
+                for (L i = 0U; i < oSize && i < nSize; i += 1)
+                {
+                    nArr[i] = std::move(this->from(i));
+                }
+            }
+            this->clear();
+            this->_data.setPntr(nArr);
+            this->_length = nSize;
+            this->_init = true;
+            return true;
+        }
+
+        inline P ptr() const
+        {
+            return this->_data;
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(std::nullptr_t)
+        {
+            this->clear();
+            if (fixedSize < 1)
+            {
+                this->_length = 0;
+                this->_init = false;
+            }
+            this->_data = nullptr;
+            return *this;
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(const BaseVct<T, P, L, 0, true>& copy)
+        {
+            //this->clear();
+            this->copy(copy);
+            return *this;
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(const BaseVct<T, P, L, fixedSize, false>& copy)
+        {
+            this->clear();
+            this->copy(copy);
+            return *this;
+        }
+
+        inline bool operator<(const T* const ptr) const
+        {
+            return this->ptr().addr() < ptr;
+        }
+
+        inline bool operator>(const T* const ptr) const
+        {
+            return this->ptr().addr() > ptr;
+        }
+
+        inline bool operator<=(const T* const ptr) const
+        {
+            return this->ptr().addr() <= ptr;
+        }
+
+        inline bool operator>=(const T* const ptr) const
+        {
+            return this->ptr().addr() >= ptr;
+        }
+
+        inline bool operator==(const T* const ptr) const
+        {
+            return this->ptr().addr() == ptr;
+        }
+
+        inline bool operator!=(const T* const ptr) const
+        {
+            return this->ptr().addr() != ptr;
+        }
+
+        inline bool operator!=(const P& cloned) const
+        {
+            return this->ptr() != cloned.ptr();
+        }
+
+        inline bool operator==(const P& cloned) const
+        {
+            return this->ptr() == cloned.ptr();
+        }
+
+        inline bool operator<=(const P& cloned) const
+        {
+            return this->ptr() <= cloned.ptr();
+        }
+
+        inline bool operator<(const P& cloned) const
+        {
+            return this->ptr() < cloned.ptr();
+        }
+
+        inline bool operator>(const P& cloned) const
+        {
+            return this->ptr() > cloned.ptr();
+        }
+
+        inline bool operator>=(const P& cloned) const
+        {
+            return this->ptr() >= cloned.ptr();
+        }
+
+        inline bool operator!=(const BaseVct& cloned) const
+        {
+            return this->ptr() != cloned.ptr();
+        }
+
+        inline bool operator==(const BaseVct& cloned) const
+        {
+            return this->ptr() == cloned.ptr();
+        }
+
+        inline bool operator<=(const BaseVct& cloned) const
+        {
+            return this->ptr() <= cloned.ptr();
+        }
+
+        inline bool operator<(const BaseVct& cloned) const
+        {
+            return this->ptr() < cloned.ptr();
+        }
+
+        inline bool operator>(const BaseVct& cloned) const
+        {
+            return this->ptr() > cloned.ptr();
+        }
+
+        inline bool operator>=(const BaseVct& cloned) const
+        {
+            return this->ptr() >= cloned.ptr();
+        }
+
+        inline operator P() const
+        {
+           return this->ptr();
+        }
+
+        inline operator bool() const
+        {
+            return const_cast<BaseVct*>(this)->_data;
+        }
+
+        inline T& operator[](const L index)
+        {
+           return this->from(index);
+        }
+
+        inline const T& operator[](const L index) const
+        {
+           return this->from(index);
+        }
+
+        //template<L newSize = 0>
+        inline operator BaseVct<T, P, L, 0, true>() const
+        {
+            //static_assert(fixedSize < 1 || newSize <= fixedSize, "The compressed array passed, has fewer elements than required.");
+            //BaseVct<T, P, L, newSize, false> ret;
+            BaseVct<T, P, L, 0, true> ret;
+            ret._data = this->_data;
+            //if constexpr(newSize < 1)
+            {
+                const auto size = this->size();
+                //assert(size <= newSize);
+                ret._length = size;
+                ret._init = false;
+            }
+            return ret;
+        }
+
+        /*inline BaseVct<T, P, L, fixedSize, dispose>(std::nullptr_t)
+        {
+            if constexpr(fixedSize < 1)
+            {
+                this->_init = false;
+                this->_length = 0;
+            }
+            this->_data = P(nullptr);
+        }*/
+
+        inline BaseVct<T, P, L, fixedSize, dispose>(const BaseVct<T, P, L, 0, true>& copy)
+        {
+            this->copy(copy);
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>(const BaseVct<T, P, L, fixedSize, false>& copy)
+        {
+            this->copy(copy);
+        }
+
+        /*
+        Views the elements without owning them; storage handed over to the vector goes through adopt() instead, so arrays made by new[]
+        cannot end up released as if they came from allocate().
+        */
+        inline BaseVct<T, P, L, fixedSize, dispose>(const P beginPtr, const L size = fixedSize)
+        {
+            static_assert(fixedSize < 1 || !dispose, "Owned fixed-size vectors have to be created by adopt().");
+            //static_assert(fixedSize < 1 || size <= fixedSize, "The size cannot be higher, than the fixed length.");
+            assert(fixedSize < 1 || size <= fixedSize);
+            this->_data = beginPtr;
+            if constexpr(fixedSize < 1)
+            {
+                this->_length = size < 0 ? size * -1 : size;
+                this->_init = false;
+            }
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>(T* beginPtr, const L size = fixedSize)
+        {
+            static_assert(fixedSize < 1 || !dispose, "Owned fixed-size vectors have to be created by adopt().");
+            //static_assert(fixedSize < 1 || size <= fixedSize, "The size cannot be higher, than the fixed length.");
+            assert(fixedSize < 1 || size <= fixedSize);
+            this->_data = beginPtr;
+            if constexpr(fixedSize < 1)
+            {
+                this->_length = size < 0 ? size * -1 : size;
+                this->_init = false;
+            }
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>(std::initializer_list<T> list)
+        {
+            //if constexpr(fixedSize < 1)
+            {
+                L i = 0U;
+                auto end = list.end();
+                auto size = list.size();
+                const std::size_t count = fixedSize < 1 ? size : fixedSize;
+                auto data = allocate(count);
+                //auto length = sizeof(T) * size;
+                //auto data = alloc(length);
+                if (data)
+                {
+                    for (auto it = list.begin(); i < count && it != end; ++it)
+                    {
+                        (const_cast<typename std::remove_const<T>::type&>(data[i++])) = const_cast<typename std::remove_const<T>::type&>(*it);
+                    }
+                    this->_data = const_cast<typename std::remove_const<T>::type*>(data);
+                    //std::memcpy(const_cast<void*>(static_cast<const void*>(const_cast<const T*>(data))), list.begin(), length);
+                    //std::memcpy(data, list.begin(), length);
+                    //this->_data = P(static_cast<T*>(data));
+                    if constexpr(fixedSize < 1)
+                    {
+                        this->_length = size;
+                        this->_init = true;
+                    }
+                }
+                else
+                {
+                    this->_data = P(nullptr);
+                    if constexpr(fixedSize < 1)
+                    {
+                        this->_init = false;
+                        this->_length = 0U;
+                    }
+                }
+            }
+            /*else
+            {
+                //static_assert(fixedSize <= list.size(), "The initialization list passed, has fewer elements than required.");
+                assert(fixedSize <= list.size());
+                this->_data = const_cast<typename std::remove_const_t<T*>>(list.begin());
+                if constexpr(fixedSize < 1)
+                {
+                    this->_init = false;
+                    this->_length = list.size();
+                }
+            }*/
+        }
+
+        inline BaseVct<T, P, L, fixedSize, dispose>()
+        {
+            this->_data = nullptr;
+            if constexpr(fixedSize < 1)
+            {
+                this->_init = false;
+                this->_length = 0;
+            }
+        }
+
+        inline ~BaseVct()
+        {
+            this->clear();
+        }
+
+        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
+    };
+
+    template<typename T = void, const int own = 0, const int opt = 2, const int level = CMPS_LEVEL>
+    using CmpsPtr = BaseCmp<T, own, opt, level>;
+    template<typename T = void, const bool weak = false, const int cow = -1, const int opt = -1, typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
+    using CmpsCnt = BaseCnt<T, cow, weak, opt, C, level>;
+    template<typename T = void, const bool weak = false, const int cow = -1, const int opt = -1, const int level = CMPS_LEVEL>
+    using CmpsHotCnt = BaseCnt<T, cow, weak, opt, CmpsStripedCount, level>;
+    template<typename T, typename L = uint32_t, const L fixedSize = 0, typename P = CmpsPtr<T>, const bool dispose = fixedSize < 1>
+    using CmpsVct = BaseVct<T, P, L, fixedSize, dispose>;
 
-void* operator new(const std::size_t size)
-{
-    auto ptr = alloc(size);
-    if (ptr)
+    template <typename T, const int own, const int opt, const int level>
+    struct CmpsRelocatable<BaseCmp<T, own, opt, level>> : std::true_type {};
+
+    template <typename T, const int cow, const bool weak, const int opt, typename C, const int level>
+    struct CmpsRelocatable<BaseCnt<T, cow, weak, opt, C, level>> : std::bool_constant<cow != 0> {};
+
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+    struct CmpsRelocatable<BaseVct<T, P, L, fixedSize, dispose>> : CmpsRelocatable<P> {};
+#ifndef CMPS_STD_ONLY
+    /*
+    Vectors of trivially copyable elements are written to data streams as their length, followed by all their elements in a single raw
+    block, and are read back directly into their storage, which is reallocated first, unless its length is fixed and already matching.
+    */
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+    QDataStream& operator<<(QDataStream& stream, const BaseVct<T, P, L, fixedSize, dispose>& vct)
     {
-        return ptr;
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be written as raw blocks.");
+        const uint32_t size = static_cast<uint32_t>(vct.size());
+        stream << size;
+        if (size > 0U)
+        {
+            stream.writeRawData(reinterpret_cast<const char*>(vct.cbegin()), static_cast<int>(size * sizeof(T)));
+        }
+        return stream;
     }
-    else
+
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+    QDataStream& operator>>(QDataStream& stream, BaseVct<T, P, L, fixedSize, dispose>& vct)
     {
-        throw std::bad_alloc {};
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be read as raw blocks.");
+        uint32_t size = 0U;
+        stream >> size;
+        if (stream.status() != QDataStream::Ok)
+        {
+            return stream;
+        }
+        if constexpr(fixedSize < 1)
+        {
+            if (!vct.resize(static_cast<L>(size)))
+            {
+                stream.setStatus(QDataStream::ReadCorruptData);
+                return stream;
+            }
+        }
+        else if (size != fixedSize)
+        {
+            stream.setStatus(QDataStream::ReadCorruptData);
+            return stream;
+        }
+        const int length = static_cast<int>(size * sizeof(T));
+        if (size > 0U && stream.readRawData(reinterpret_cast<char*>(vct.begin()), length) != length)
+        {
+            stream.setStatus(QDataStream::ReadPastEnd);
+        }
+        return stream;
     }
-}
 
-void operator delete(void* ptr) noexcept
-{
-    clear(ptr);
-}
-#else
-inline void* alloc(const std::size_t size)
-{
-    return std::malloc(size);
-}
+    /*
+    Returns a byte array sharing the storage of the vector, which must outlive it and remain unchanged while it is used.
+    */
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+    inline QByteArray cmpsByteView(const BaseVct<T, P, L, fixedSize, dispose>& vct)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be viewed as bytes.");
+        return QByteArray::fromRawData(reinterpret_cast<const char*>(vct.cbegin()), static_cast<int>(vct.size() * sizeof(T)));
+    }
 
-inline void clear(void* ptr) noexcept
-{
-    free(ptr);
-}
+    /*
+    Returns a non-owning vector of the elements held by the byte array, which must outlive it and remain unchanged while it is used;
+    if the data is not aligned for T, or could only be stored by listing its address, the elements are copied to an owned buffer instead.
+    */
+    template<typename T, typename L = uint32_t, typename P = CmpsPtr<T>>
+    BaseVct<T, P, L, 0, false> cmpsVctView(const QByteArray& bytes)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable elements can be viewed from bytes.");
+        const L size = static_cast<L>(static_cast<std::size_t>(bytes.size()) / sizeof(T));
+        if (size == 0U)
+        {
+            return BaseVct<T, P, L, 0, false>();
+        }
+        auto data = bytes.constData();
+        const uintptr_t addr = reinterpret_cast<uintptr_t>(data);
+        constexpr uintptr_t align = alignof(T) > (static_cast<uintptr_t>(1U) << P::shiftLen()) ? alignof(T) : (static_cast<uintptr_t>(1U) << P::shiftLen());
+        if (addr % align == 0U && addr < P::maxAddr())
+        {
+            return BaseVct<T, P, L, 0, false>(reinterpret_cast<T*>(const_cast<char*>(data)), size);
+        }
+        auto copy = BaseVct<T, P, L, 0, false>::allocate(size);
+        if (copy == nullptr)
+        {
+            throw std::bad_alloc {};
+        }
+        std::memcpy(static_cast<void*>(copy), data, size * sizeof(T));
+        return BaseVct<T, P, L, 0, false>::adopt(copy, size);
+    }
 #endif
 
-namespace cmpsptr
-{
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose, typename F>
+    void parallelForEach(const BaseVct<T, P, L, fixedSize, dispose>& vct, F fn)
+    {
+        auto data = vct.begin();
+        const std::size_t size = vct.size();
+        TaskPool::parallelFor(size, TaskPool::chunkSize<T>(size), [data, &fn](const std::size_t begin, const std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; i += 1U)
+            {
+                fn(data[i]);
+            }
+        });
+    }
 
-    template <typename P>
-    struct FixData
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose,
+             typename O, typename Q, typename M, const M outSize, const bool outDispose, typename F>
+    bool parallelTransform(const BaseVct<T, P, L, fixedSize, dispose>& vct, BaseVct<O, Q, M, outSize, outDispose>& out, F fn)
     {
-        P _data;
+        const std::size_t size = vct.size();
+        if (out.size() < size)
+        {
+            return false;
+        }
+        auto data = vct.begin();
+        auto outData = out.begin();
+        TaskPool::parallelFor(size, TaskPool::chunkSize<O>(size), [data, outData, &fn](const std::size_t begin, const std::size_t end)
+        {
+            for (std::size_t i = begin; i < end; i += 1U)
+            {
+                outData[i] = fn(data[i]);
+            }
+        });
+        return true;
+    }
+
+    /*
+    Folds the elements in parallel, like std::transform_reduce: every chunk starts from a copy of identity and accumulates its
+    elements with fn(R, T), then the partial results are merged in order with combine(R, R), which must be associative and
+    leave any value unchanged when merged with identity; R only has to be copyable, not default constructible.
+    */
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose, typename R, typename F, typename C>
+    R parallelReduce(const BaseVct<T, P, L, fixedSize, dispose>& vct, R identity, F fn, C combine)
+    {
+        auto data = vct.begin();
+        const std::size_t size = vct.size();
+        const std::size_t chunkSize = TaskPool::chunkSize<T>(size);
+        const std::size_t chunks = (size + chunkSize - 1U) / chunkSize;
+        if (chunks < 2U)
+        {
+            for (std::size_t i = 0U; i < size; i += 1U)
+            {
+                identity = fn(identity, data[i]);
+            }
+            return identity;
+        }
+        std::vector<R> partials(chunks, identity);
+        TaskPool::parallelFor(size, chunkSize, [data, chunkSize, &partials, &fn](const std::size_t begin, const std::size_t end)
+        {
+            R& partial = partials[begin / chunkSize];
+            for (std::size_t i = begin; i < end; i += 1U)
+            {
+                partial = fn(partial, data[i]);
+            }
+        });
+        R result = std::move(partials[0U]);
+        for (std::size_t i = 1U; i < chunks; i += 1U)
+        {
+            result = combine(result, partials[i]);
+        }
+        return result;
+    }
+
+    /*
+    Folds elements of the same type as the result in parallel with an associative fn, seeding every chunk with its first element,
+    so init is applied once and does not need to be an identity; heterogeneous folds have to pass a separate combine instead.
+    */
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose, typename R, typename F>
+    R parallelReduce(const BaseVct<T, P, L, fixedSize, dispose>& vct, R init, F fn)
+    {
+        static_assert(std::is_same<T, R>::value, "Folds into another type need an identity and a separate combine function.");
+        auto data = vct.begin();
+        const std::size_t size = vct.size();
+        const std::size_t chunkSize = TaskPool::chunkSize<T>(size);
+        const std::size_t chunks = (size + chunkSize - 1U) / chunkSize;
+        if (chunks < 2U)
+        {
+            for (std::size_t i = 0U; i < size; i += 1U)
+            {
+                init = fn(init, data[i]);
+            }
+            return init;
+        }
+        std::vector<T> partials;
+        partials.reserve(chunks);
+        for (std::size_t i = 0U; i < chunks; i += 1U)
+        {
+            partials.push_back(data[i * chunkSize]);
+        }
+        TaskPool::parallelFor(size, chunkSize, [data, chunkSize, &partials, &fn](const std::size_t begin, const std::size_t end)
+        {
+            T& partial = partials[begin / chunkSize];
+            for (std::size_t i = begin + 1U; i < end; i += 1U)
+            {
+                partial = fn(partial, data[i]);
+            }
+        });
+        for (std::size_t i = 0U; i < chunks; i += 1U)
+        {
+            init = fn(init, partials[i]);
+        }
+        return init;
+    }
+
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose, typename F>
+    L parallelFindIf(const BaseVct<T, P, L, fixedSize, dispose>& vct, F fn)
+    {
+        auto data = vct.begin();
+        const std::size_t size = vct.size();
+        std::atomic<std::size_t> found = size;
+        TaskPool::parallelFor(size, TaskPool::chunkSize<T>(size), [data, &found, &fn](const std::size_t begin, const std::size_t end)
+        {
+            for (std::size_t i = begin; i < end && i < found.load(std::memory_order_relaxed); i += 1U)
+            {
+                if (fn(data[i]))
+                {
+                    auto prev = found.load(std::memory_order_relaxed);
+                    while (i < prev && !found.compare_exchange_weak(prev, i, std::memory_order_relaxed));
+                    return;
+                }
+            }
+        });
+        return static_cast<L>(found.load(std::memory_order_relaxed));
+    }
+
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+    inline L parallelFind(const BaseVct<T, P, L, fixedSize, dispose>& vct, const T& comp)
+    {
+        return parallelFindIf(vct, [&comp](const T& elem) { return elem == comp; });
+    }
+
+    template<typename T, typename P, typename L, const L fixedSize, const bool dispose, typename F = std::less<T>>
+    void parallelSort(BaseVct<T, P, L, fixedSize, dispose>& vct, F fn = F())
+    {
+        auto data = vct.begin();
+        const std::size_t size = vct.size();
+        const std::size_t chunkSize = TaskPool::chunkSize<T>(size);
+        TaskPool::parallelFor(size, chunkSize, [data, &fn](const std::size_t begin, const std::size_t end)
+        {
+            std::sort(data + begin, data + end, fn);
+        });
+        for (std::size_t width = chunkSize; width < size; width *= 2U)
+        {
+            const std::size_t pairs = (size + (width * 2U) - 1U) / (width * 2U);
+            TaskPool::parallelFor(pairs, 1U, [data, size, width, &fn](const std::size_t begin, const std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; i += 1U)
+                {
+                    const std::size_t first = i * width * 2U;
+                    const std::size_t middle = first + width;
+                    if (middle < size)
+                    {
+                        const std::size_t last = middle + width;
+                        std::inplace_merge(data + first, data + middle, data + (last < size ? last : size), fn);
+                    }
+                }
+            });
+        }
+    }
+
+    /*
+    Compressed values are 32-bit integers ordered like the addresses they encode, so vectors of compressed pointers are sorted by four
+    LSD radix passes of 8 bits over the raw values, skipping the passes whose digit is the same for all of them; listed entries are moved
+    after the compressed ones and ordered by their decoded address. Only the raw values are permuted, so the pointer list is not touched.
+    */
+    struct CmpsOps
+    {
+    protected:
+        static void radix(uint32_t* keys, uint32_t* temp, const std::size_t count)
+        {
+            std::size_t counts[4][256] = {};
+            for (std::size_t i = 0U; i < count; i += 1U)
+            {
+                const uint32_t key = keys[i];
+                counts[0][key & 255U] += 1U;
+                counts[1][(key >> 8) & 255U] += 1U;
+                counts[2][(key >> 16) & 255U] += 1U;
+                counts[3][key >> 24] += 1U;
+            }
+            auto source = keys;
+            for (uint32_t pass = 0U; pass < 4U; pass += 1U)
+            {
+                const uint32_t shift = pass << 3;
+                auto passCounts = counts[pass];
+                if (passCounts[(source[0] >> shift) & 255U] == count)
+                {
+                    continue;
+                }
+                std::size_t offset = 0U;
+                for (uint32_t digit = 0U; digit < 256U; digit += 1U)
+                {
+                    const std::size_t digitCount = passCounts[digit];
+                    passCounts[digit] = offset;
+                    offset += digitCount;
+                }
+                for (std::size_t i = 0U; i < count; i += 1U)
+                {
+                    const uint32_t key = source[i];
+                    temp[passCounts[(key >> shift) & 255U]++] = key;
+                }
+                std::swap(source, temp);
+            }
+            if (source != keys)
+            {
+                std::memcpy(keys, source, count * sizeof(uint32_t));
+            }
+        }
+
+    public:
+        template<typename E>
+        static void sort(E* const data, const std::size_t size)
+        {
+            if (size < 2U)
+            {
+                return;
+            }
+            if constexpr(std::is_same_v<decltype(data->_ptr), uint32_t>)
+            {
+                std::vector<uint32_t> keys(size);
+                std::vector<std::pair<uintptr_t, uint32_t>> listed;
+                std::size_t count = 0U;
+                for (std::size_t i = 0U; i < size; i += 1U)
+                {
+                    const uint32_t key = data[i]._ptr;
+    #if COMPRESS_POINTERS > 0
+                    if ((key & 1U) == 1U)
+                    {
+                        listed.emplace_back(reinterpret_cast<uintptr_t>(data[i].addr()), key);
+                        continue;
+                    }
+    #endif
+                    keys[count++] = key;
+                }
+                if (count > 1U)
+                {
+                    std::vector<uint32_t> temp(count);
+                    radix(keys.data(), temp.data(), count);
+                }
+                std::sort(listed.begin(), listed.end());
+                for (std::size_t i = 0U; i < count; i += 1U)
+                {
+                    data[i]._ptr = keys[i];
+                }
+                for (std::size_t i = count; i < size; i += 1U)
+                {
+                    data[i]._ptr = listed[i - count].second;
+                }
+            }
+            else
+            {
+                std::sort(data, data + size, [](const E& first, const E& second) { return first._ptr < second._ptr; });
+            }
+        }
+
+        template<typename E, typename L, typename F>
+        static L group(E* const data, const std::size_t size, F& fn)
+        {
+            sort(data, size);
+            L groups = 0U;
+            for (std::size_t i = 0U, j; i < size; i = j)
+            {
+                auto target = data[i].addr();
+                for (j = i + 1U; j < size && data[j].addr() == target; j += 1U);
+                if (target)
+                {
+                    fn(target, data + i, static_cast<L>(j - i));
+                    groups += 1U;
+                }
+            }
+            return groups;
+        }
+
+    protected:
+    #ifdef CMPS_X86_SIMD
+        __attribute__((target("avx2")))
+        static inline __m256i gatherMask(const __m256i keys)
+        {
+            auto skip = _mm256_cmpeq_epi32(keys, _mm256_setzero_si256());
+        #if COMPRESS_POINTERS > 0
+            const __m256i one = _mm256_set1_epi32(1);
+            skip = _mm256_or_si256(skip, _mm256_cmpeq_epi32(_mm256_and_si256(keys, one), one));
+        #endif
+            return _mm256_xor_si256(skip, _mm256_set1_epi32(-1));
+        }
+
+        template<const int shift>
+        __attribute__((target("avx2")))
+        static std::size_t gather32(const uint32_t* const keys, const char* const base, char* const out, const std::size_t count, const int32_t def)
+        {
+            const __m256i bias = _mm256_set1_epi32(INT32_MIN);
+            const __m256i fill = _mm256_set1_epi32(def);
+            std::size_t i = 0U;
+            for (; i + 8U <= count; i += 8U)
+            {
+                const auto raw = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+                const auto values = _mm256_mask_i32gather_epi32(fill, reinterpret_cast<const int*>(base), _mm256_xor_si256(raw, bias),
+                                                                gatherMask(raw), 1 << shift);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 4U), values);
+            }
+            return i;
+        }
+
+        template<const int shift>
+        __attribute__((target("avx2")))
+        static std::size_t gather64(const uint32_t* const keys, const char* const base, char* const out, const std::size_t count, const int64_t def)
+        {
+            const __m128i bias = _mm_set1_epi32(INT32_MIN);
+            const __m256i fill = _mm256_set1_epi64x(def);
+            std::size_t i = 0U;
+            for (; i + 4U <= count; i += 4U)
+            {
+                const auto raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                const auto mask = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(gatherMask(_mm256_castsi128_si256(raw))));
+                const auto values = _mm256_mask_i32gather_epi64(fill, reinterpret_cast<const long long*>(base), _mm_xor_si128(raw, bias),
+                                                                mask, 1 << shift);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i * 8U), values);
+            }
+            return i;
+        }
+    #endif
+
+    public:
+        /*
+        Reads one field of each target into out, or def for null elements; where AVX2 is available and the field is 4 or 8 bytes long,
+        the raw values are used directly as gather indices, biased by 2^31 to fit the signed index range, relative to a base address of
+        2^31 << SHIFT_LEN plus the offset of the field, with listed elements masked out and read afterwards through the pointer list.
+        */
+        template<typename E, typename T, typename F>
+        static void gather(const E* const data, const std::size_t size, F T::* const member, F* const out, const F& def)
+        {
+            std::size_t i = 0U;
+    #ifdef CMPS_X86_SIMD
+            if constexpr(std::is_same_v<decltype(data->_ptr), uint32_t> && sizeof(E) == sizeof(uint32_t) && E::SHIFT_LEN <= 3 &&
+                         std::is_trivially_copyable_v<F> && (sizeof(F) == 4U || sizeof(F) == 8U))
+            {
+                if (__builtin_cpu_supports("avx2"))
+                {
+                    alignas(T) char probe[sizeof(T)];
+                    const std::size_t offset = reinterpret_cast<char*>(&(reinterpret_cast<T*>(probe)->*member)) - probe;
+                    auto base = reinterpret_cast<const char*>((static_cast<uintptr_t>(1U) << (31 + E::SHIFT_LEN)) + offset);
+                    auto keys = reinterpret_cast<const uint32_t*>(data);
+                    if constexpr(sizeof(F) == 4U)
+                    {
+                        int32_t fill;
+                        std::memcpy(&fill, &def, sizeof(F));
+                        i = gather32<E::SHIFT_LEN>(keys, base, reinterpret_cast<char*>(out), size, fill);
+                    }
+                    else
+                    {
+                        int64_t fill;
+                        std::memcpy(&fill, &def, sizeof(F));
+                        i = gather64<E::SHIFT_LEN>(keys, base, reinterpret_cast<char*>(out), size, fill);
+                    }
+        #if COMPRESS_POINTERS > 0
+                    for (std::size_t j = 0U; j < i; j += 1U)
+                    {
+                        if ((keys[j] & 1U) == 1U)
+                        {
+                            out[j] = data[j].addr()->*member;
+                        }
+                    }
+        #endif
+                }
+            }
+    #endif
+            for (; i < size; i += 1U)
+            {
+                auto target = data[i].addr();
+                out[i] = target ? target->*member : def;
+            }
+        }
+    };
+
+    template<typename T, const int own, const int opt, const int level, typename P, typename L, const L fixedSize, const bool dispose>
+    inline void cmpsSort(BaseVct<BaseCmp<T, own, opt, level>, P, L, fixedSize, dispose>& vct)
+    {
+        CmpsOps::sort(vct.begin(), vct.size());
+    }
+
+    /*
+    Sorts the vector and calls fn(target, first, count) once for each run of elements pointing to the same non-null target,
+    returning the number of runs.
+    */
+    template<typename T, const int own, const int opt, const int level, typename P, typename L, const L fixedSize, const bool dispose, typename F>
+    inline L cmpsGroupByTarget(BaseVct<BaseCmp<T, own, opt, level>, P, L, fixedSize, dispose>& vct, F fn)
+    {
+        return CmpsOps::group<BaseCmp<T, own, opt, level>, L>(vct.begin(), vct.size(), fn);
+    }
+
+    /*
+    Reads the given field of every target into out, which must hold vct.size() values, storing def for null elements.
+    */
+    template<typename T, const int own, const int opt, const int level, typename P, typename L, const L fixedSize, const bool dispose, typename F>
+    inline void cmpsGatherField(const BaseVct<BaseCmp<T, own, opt, level>, P, L, fixedSize, dispose>& vct, F T::* const member, F* const out,
+                                const F& def = F())
+    {
+        CmpsOps::gather(vct.begin(), vct.size(), member, out, def);
+    }
+
+#if CMPS_WORDSIZE > 4
+    /*
+    Array of pointers packed in 5 bytes each, holding addresses shifted right by ALIGN_PTR_LOW_BITS, so that 40 bits cover 16TB when
+    pointers are aligned to 16 bytes; unlike compressed pointers, it has no fallback, addresses beyond this range cannot be stored.
+    Elements are read by unaligned 8 byte little-endian loads, the buffer being padded accordingly, while bulk decoding expands two
+    (SSSE3) or four (AVX2) elements per byte shuffle, if the processor supports these instructions.
+    */
+    template <typename T, typename L = uint32_t>
+    class CmpsWideVct
+    {
+    protected:
+        static constexpr std::size_t WIDTH = 5U;
+        static constexpr std::size_t PADDING = 8U;
+        static constexpr uint32_t SHIFT_LEN = ALIGN_PTR_LOW_BITS;
+        static constexpr uint64_t MASK = 0xFFFFFFFFFFULL;
+
+        std::vector<uint8_t> _data;
+        L _size = 0U;
+
+        inline static T* decode(const uint8_t* const src)
+        {
+            uint64_t raw;
+            std::memcpy(&raw, src, sizeof(uint64_t));
+            return reinterpret_cast<T*>((raw & MASK) << SHIFT_LEN);
+        }
+    #ifdef CMPS_X86_SIMD
+        __attribute__((target("ssse3")))
+        static std::size_t decodeSsse3(const uint8_t* src, T** const out, const std::size_t count)
+        {
+            const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 3, 4, -1, -1, -1, 5, 6, 7, 8, 9, -1, -1, -1);
+            std::size_t i = 0U;
+            for (; i + 2U <= count; i += 2U, src += WIDTH * 2U)
+            {
+                auto values = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_slli_epi64(values, SHIFT_LEN));
+            }
+            return i;
+        }
+
+        __attribute__((target("avx2")))
+        static std::size_t decodeAvx2(const uint8_t* src, T** const out, const std::size_t count)
+        {
+            const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, 3, 4, -1, -1, -1, 5, 6, 7, 8, 9, -1, -1, -1,
+                                                     0, 1, 2, 3, 4, -1, -1, -1, 5, 6, 7, 8, 9, -1, -1, -1);
+            std::size_t i = 0U;
+            for (; i + 4U <= count; i += 4U, src += WIDTH * 4U)
+            {
+                auto packed = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src))),
+                                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + WIDTH * 2U)), 1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_slli_epi64(_mm256_shuffle_epi8(packed, shuffle), SHIFT_LEN));
+            }
+            return i;
+        }
+    #endif
+
+    public:
+        static constexpr uintptr_t maxAddr()
+        {
+            return static_cast<uintptr_t>(MASK) << SHIFT_LEN;
+        }
+
+        inline static bool fits(const T* const ptr)
+        {
+            const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+            return addr <= maxAddr() && (addr & ((static_cast<uintptr_t>(1U) << SHIFT_LEN) - 1U)) == 0U;
+        }
+
+        inline L size() const
+        {
+            return this->_size;
+        }
+
+        inline T* operator[](const L idx) const
+        {
+            return decode(this->_data.data() + idx * WIDTH);
+        }
+
+        inline void set(const L idx, T* const ptr)
+        {
+            assert(fits(ptr));
+            const uint64_t raw = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr) >> SHIFT_LEN);
+            std::memcpy(this->_data.data() + idx * WIDTH, &raw, WIDTH);
+        }
+
+        inline void resize(const L size)
+        {
+            this->_data.resize(size ? size * WIDTH + PADDING : 0U);
+            this->_size = size;
+        }
+
+        inline void push_back(T* const ptr)
+        {
+            const L idx = this->_size;
+            this->resize(idx + 1U);
+            this->set(idx, ptr);
+        }
+
+        inline void reserve(const L size)
+        {
+            this->_data.reserve(size * WIDTH + PADDING);
+        }
+
+        inline void clear()
+        {
+            this->_data.clear();
+            this->_size = 0U;
+        }
+
+        /*
+        Decodes count elements, starting from begin, into out.
+        */
+        void decode(const L begin, const L count, T** const out) const
+        {
+            auto src = this->_data.data() + begin * WIDTH;
+            std::size_t i = 0U;
+    #ifdef CMPS_X86_SIMD
+            if (__builtin_cpu_supports("avx2"))
+            {
+                i = decodeAvx2(src, out, count);
+            }
+            else if (__builtin_cpu_supports("ssse3"))
+            {
+                i = decodeSsse3(src, out, count);
+            }
+    #endif
+            for (; i < count; i += 1U)
+            {
+                out[i] = decode(src + i * WIDTH);
+            }
+        }
 
-        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
+        inline CmpsWideVct<T, L>(const L size = 0U)
+        {
+            this->resize(size);
+        }
     };
+#endif
 
-    template <typename P, typename L>
-    struct VarData : public FixData<P>
+#ifndef CMPS_ARENA_SIZE
+    #define CMPS_ARENA_SIZE 4294967296UL
+#endif
+    /*
+    The arena reserves a single region of virtual memory below the compressible limit, from which it hands out blocks by bumping an atomic
+    offset, so that any address it returns can be stored by CmpsPtr without falling back to the pointer list; released blocks are reused
+    when they are at the top of the region, or otherwise kept in a free map, which is searched only while it is not empty, the unused
+    tail of a larger block being put back in the map when it is split.
+    */
+    class CmpsArena : public std::pmr::memory_resource
     {
-        L _init: 1;
-        L _length: (sizeof(L) * 8) - 1;
-
-        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
-    };
+    protected:
+    #ifdef ALIGN_POINTERS
+        static constexpr std::size_t MIN_ALIGN = (ALIGN_POINTERS) < 16U ? 16U : (ALIGN_POINTERS);
+    #else
+        static constexpr std::size_t MIN_ALIGN = 16U;
+    #endif
 
-    template<typename T, typename P = BaseCmp<T>, typename L = uint32_t, const L fixedSize = 0, const bool dispose = fixedSize < 1>
-    class BaseVct : protected std::conditional_t<fixedSize < 1, VarData<P, L>, FixData<P>>
-    {
+        char* _begin = nullptr;
+        std::size_t _size = 0U;
+        std::atomic<std::size_t> _used = 0U;
+        std::atomic<std::size_t> _free_len = 0U;
+        std::multimap<std::size_t, void*> _free_map;
+        CmpsMutex _locker;
 
-    protected:
-        inline void clear()
+        static char* reserve(const std::size_t size)
         {
-            if constexpr(dispose || fixedSize < 1)
+            constexpr uintptr_t limit = CmpsPtr<char>::maxAddr();
+            for (int i = 3; i > 0; i -= 1)
             {
-               if constexpr(fixedSize < 1)
-               {
-                   if (!this->init())
-                   {
-                       return;
-                   }
-               }
-               auto ptr = this->_data.addr();
-               if (ptr)
-               {
-                   this->_data.setPntr(nullptr);
-                   delete[] ptr;
-               }
+                uintptr_t hint = COMPRESS_POINTERS == 0 ? 0U : ((limit >> i) & ~static_cast<uintptr_t>(65535U));
+                if (hint > limit - size)
+                {
+                    continue;
+                }
+    #ifdef CMPS_OS_WINDOWS
+                auto region = static_cast<char*>(VirtualAlloc(reinterpret_cast<void*>(hint), size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE));
+                if (region == nullptr)
+                {
+                    continue;
+                }
+                if (reinterpret_cast<uintptr_t>(region) > limit - size)
+                {
+                    VirtualFree(region, 0, MEM_RELEASE);
+                    continue;
+                }
+    #else
+                void* region = mmap(reinterpret_cast<void*>(hint), size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+                if (region == MAP_FAILED)
+                {
+                    continue;
+                }
+                if (reinterpret_cast<uintptr_t>(region) > limit - size)
+                {
+                    munmap(region, size);
+                    continue;
+                }
+    #endif
+                return static_cast<char*>(region);
             }
+            return nullptr;
         }
 
-        inline T& from(const L index) const
+        void* reuse(const std::size_t bytes, const std::size_t align)
         {
-            return const_cast<BaseVct*>(this)->_data.addr()[index];
+            auto uniqueLocker = CmpsLocker(&this->_locker);
+            auto freeMap = &this->_free_map;
+            auto freeEnd = freeMap->end();
+            for (auto itr = freeMap->lower_bound(bytes); itr != freeEnd; ++itr)
+            {
+                auto ptr = itr->second;
+                if ((reinterpret_cast<uintptr_t>(ptr) & (align - 1U)) == 0U)
+                {
+                    const std::size_t rest = itr->first - bytes;
+                    freeMap->erase(itr);
+                    if (rest > 0U)
+                    {
+                        freeMap->emplace(rest, static_cast<char*>(ptr) + bytes);
+                    }
+                    else
+                    {
+                        this->_free_len.fetch_sub(1U, std::memory_order_relaxed);
+                    }
+                    return ptr;
+                }
+            }
+            return nullptr;
         }
 
-        inline void copy(const BaseVct<T, P, L, 0, true>& copy)
+        void* do_allocate(std::size_t bytes, std::size_t align) override
         {
-            if constexpr(fixedSize < 1)
+            auto ptr = this->allocate(bytes, align);
+            if (ptr == nullptr)
             {
-                auto size = copy.size();
-                assert(fixedSize < 1 || fixedSize < size);
-                this->_length = size;
-                this->_init = false;
+                throw std::bad_alloc {};
             }
-            this->_data = copy._data;
+            return ptr;
         }
 
-        inline void copy(const BaseVct<T, P, L, fixedSize, false>& copy)
+        void do_deallocate(void* ptr, std::size_t bytes, std::size_t align) override
         {
-            if constexpr(fixedSize < 1)
-            {
-                this->_length = copy.size();
-                this->_init = false;
-            }
-            this->_data = copy._data;
+            this->release(ptr, bytes, align);
         }
 
-        inline bool init() const
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
         {
-            if constexpr(fixedSize < 1)
+            return this == &other;
+        }
+
+    public:
+        inline bool contains(const void* const ptr) const
+        {
+            auto addr = static_cast<const char*>(ptr);
+            return addr >= this->_begin && addr < this->_begin + this->_size;
+        }
+
+        inline std::size_t size() const
+        {
+            return this->_size;
+        }
+
+        inline std::size_t used() const
+        {
+            return this->_used.load(std::memory_order_relaxed);
+        }
+
+        inline uint32_t compress(const void* const ptr) const
+        {
+            return ptr ? static_cast<uint32_t>((static_cast<const char*>(ptr) - this->_begin) / MIN_ALIGN) + 1U : 0U;
+        }
+
+        inline void* expand(const uint32_t idx) const
+        {
+            return idx ? this->_begin + (static_cast<std::size_t>(idx - 1U) * MIN_ALIGN) : nullptr;
+        }
+
+        void* allocate(std::size_t bytes, std::size_t align = MIN_ALIGN)
+        {
+            if (align < MIN_ALIGN)
             {
-                if (this == nullptr)
+                align = MIN_ALIGN;
+            }
+            bytes = (bytes + MIN_ALIGN - 1U) & ~(MIN_ALIGN - 1U);
+            if (this->_free_len.load(std::memory_order_relaxed) > 0U)
+            {
+                auto ptr = this->reuse(bytes, align);
+                if (ptr)
                 {
-                    return false;
+                    return ptr;
                 }
-                return this->_init;
             }
-            else
+            auto used = this->_used.load(std::memory_order_relaxed);
+            std::size_t start;
+            do
             {
-                return false;
+                start = (used + align - 1U) & ~(align - 1U);
+                if (start + bytes > this->_size)
+                {
+                    return nullptr;
+                }
             }
+            while (!this->_used.compare_exchange_weak(used, start + bytes, std::memory_order_relaxed));
+            return this->_begin + start;
         }
 
-    public:
-        inline T* begin()
+        void release(void* const ptr, std::size_t bytes, const std::size_t = MIN_ALIGN)
         {
-            return this->_data.addr();
+            if (ptr == nullptr)
+            {
+                return;
+            }
+            bytes = (bytes + MIN_ALIGN - 1U) & ~(MIN_ALIGN - 1U);
+            std::size_t end = (static_cast<char*>(ptr) - this->_begin) + bytes;
+            if (this->_used.compare_exchange_strong(end, end - bytes, std::memory_order_relaxed))
+            {
+                return;
+            }
+            auto uniqueLocker = CmpsLocker(&this->_locker);
+            this->_free_map.emplace(bytes, ptr);
+            this->_free_len.fetch_add(1U, std::memory_order_relaxed);
         }
 
-        inline T* end()
+        /*
+        The process-wide arena is never destroyed, since static containers built on it may still release their memory while the program
+        exits, after a function-local static would already have been unmapped.
+        */
+        static CmpsArena& global()
         {
-            return &(this->_data.addr()[this->size() - 1]);
+            static CmpsArena& arena = *new CmpsArena;
+            return arena;
         }
 
-        inline const T* cbegin() const
+        CmpsArena(const CmpsArena&) = delete;
+        CmpsArena& operator=(const CmpsArena&) = delete;
+
+        inline CmpsArena(std::size_t size = CMPS_ARENA_SIZE)
         {
-            return this->_data.addr();
+            constexpr std::size_t limit = CmpsPtr<char>::maxAddr() >> 2;
+            if (size > limit)
+            {
+                size = limit;
+            }
+            size &= ~static_cast<std::size_t>(65535U);
+            this->_begin = reserve(size);
+            this->_size = this->_begin ? size : 0U;
         }
 
-        inline const T* cend() const
+        inline ~CmpsArena()
         {
-            return &(this->_data.addr()[this->size() - 1]);
+            if (this->_begin)
+            {
+    #ifdef CMPS_OS_WINDOWS
+                VirtualFree(this->_begin, 0, MEM_RELEASE);
+    #else
+                munmap(this->_begin, this->_size);
+    #endif
+            }
         }
+    };
 
-        inline T* begin() const
+    class CmpsMonotonicResource : public std::pmr::monotonic_buffer_resource
+    {
+    public:
+        inline CmpsMonotonicResource(const std::size_t initialSize = 4096U, CmpsArena& arena = CmpsArena::global())
+            : std::pmr::monotonic_buffer_resource(initialSize, &arena) {}
+    };
+
+    class CmpsPoolResource : public std::pmr::unsynchronized_pool_resource
+    {
+    public:
+        inline CmpsPoolResource(const std::pmr::pool_options& options = {}, CmpsArena& arena = CmpsArena::global())
+            : std::pmr::unsynchronized_pool_resource(options, &arena) {}
+    };
+
+    class CmpsSyncPoolResource : public std::pmr::synchronized_pool_resource
+    {
+    public:
+        inline CmpsSyncPoolResource(const std::pmr::pool_options& options = {}, CmpsArena& arena = CmpsArena::global())
+            : std::pmr::synchronized_pool_resource(options, &arena) {}
+    };
+
+    /*
+    Blocks of a given size are carved from the arena in slabs and linked through their first bytes by 32bit arena offsets; each thread keeps
+    its own chain of free blocks, exchanging them with a global lock-free stack in batches, whose head is paired with a tag in a single 64bit
+    word, so that compare-and-swap operations cannot be confused by a batch being popped and pushed back in the meantime (ABA).
+    */
+    template <const std::size_t size, const std::size_t align = 16U>
+    class BlockPool
+    {
+    protected:
+        static constexpr std::size_t BLOCK_ALIGN = align < 16U ? 16U : align;
+        static constexpr std::size_t BLOCK_SIZE = (size + BLOCK_ALIGN - 1U) & ~(BLOCK_ALIGN - 1U);
+        static constexpr uint32_t BATCH_SIZE = BLOCK_SIZE > 1024U ? 16U : 64U;
+
+        struct Block
         {
-            return this->_data.addr();
+            uint32_t next;
+            uint32_t nextBatch;
+            uint32_t length;
+        };
+
+        struct Cache
+        {
+            uint32_t head = 0U;
+            uint32_t length = 0U;
+
+            inline ~Cache()
+            {
+                if (this->head)
+                {
+                    BlockPool<size, align>::pushBatch(this->head, this->length);
+                }
+            }
+        };
+
+        inline static std::atomic<uint64_t> _batches = 0U;
+        inline static thread_local Cache _cache;
+
+        inline static Block* block(const uint32_t idx)
+        {
+            return static_cast<Block*>(CmpsArena::global().expand(idx));
         }
 
-        inline T* end() const
+        static void pushBatch(const uint32_t head, const uint32_t length)
         {
-            return &(this->_data.addr()[this->size() - 1]);
+            auto batch = block(head);
+            batch->length = length;
+            auto batches = _batches.load(std::memory_order_relaxed);
+            do
+            {
+                batch->nextBatch = static_cast<uint32_t>(batches);
+            }
+            while (!_batches.compare_exchange_weak(batches, ((batches >> 32) + 1U) << 32 | head,
+                                                   std::memory_order_release, std::memory_order_relaxed));
         }
 
-        inline const L size() const
+        static uint32_t popBatch(uint32_t& length)
         {
-            if constexpr(fixedSize < 1)
+            auto batches = _batches.load(std::memory_order_acquire);
+            uint32_t head;
+            do
             {
-                return this->_length;
+                head = static_cast<uint32_t>(batches);
+                if (head == 0U)
+                {
+                    return 0U;
+                }
             }
-            else
+            while (!_batches.compare_exchange_weak(batches, ((batches >> 32) + 1U) << 32 | block(head)->nextBatch,
+                                                   std::memory_order_acquire, std::memory_order_acquire));
+            length = block(head)->length;
+            return head;
+        }
+
+        static uint32_t carve(uint32_t& length)
+        {
+            auto& arena = CmpsArena::global();
+            auto slab = static_cast<char*>(arena.allocate(BLOCK_SIZE * BATCH_SIZE, BLOCK_ALIGN));
+            if (slab == nullptr)
             {
-                return fixedSize;
+                return 0U;
+            }
+            uint32_t head = 0U;
+            for (uint32_t i = BATCH_SIZE; i > 0U; i -= 1U)
+            {
+                auto block = slab + ((i - 1U) * BLOCK_SIZE);
+                reinterpret_cast<Block*>(block)->next = head;
+                head = arena.compress(block);
             }
+            length = BATCH_SIZE;
+            return head;
         }
 
-        inline const T& at(const L index) const
+    public:
+        static void* alloc()
         {
-            return const_cast<BaseVct*>(this)->from(index);
+            auto cache = &_cache;
+            auto head = cache->head;
+            if (head == 0U)
+            {
+                uint32_t length = 0U;
+                head = popBatch(length);
+                if (head == 0U)
+                {
+                    head = carve(length);
+                    if (head == 0U)
+                    {
+                        return nullptr;
+                    }
+                }
+                cache->length = length;
+            }
+            auto ptr = block(head);
+            cache->head = ptr->next;
+            cache->length -= 1U;
+            return ptr;
         }
 
-        bool contains(const T& comp) const
+        static void clear(void* const ptr)
         {
-            const auto size = this->size();
-            for (L i = 0U; i < size; i += 1)
+            auto cache = &_cache;
+            auto ptrBlock = static_cast<Block*>(ptr);
+            ptrBlock->next = cache->head;
+            cache->head = CmpsArena::global().compress(ptr);
+            if ((cache->length += 1U) == BATCH_SIZE * 2U)
             {
-                if (this->at(i) == comp)
+                auto last = ptrBlock;
+                for (uint32_t i = 1U; i < BATCH_SIZE; i += 1U)
                 {
-                    return true;
+                    last = block(last->next);
                 }
+                auto head = cache->head;
+                cache->head = last->next;
+                cache->length = BATCH_SIZE;
+                last->next = 0U;
+                pushBatch(head, BATCH_SIZE);
             }
-            return false;
         }
+    };
 
-        L indexOf(const T& comp) const
+    /*
+    Every object allocated by the pool lies inside the arena, therefore it can always be compressed; types deriving from CmpsPooled, are
+    created and deleted through the pool by the new and delete operators, including when they are owned by compressed pointers.
+    */
+    template <typename T>
+    class CmpsPool : public BlockPool<sizeof(T), alignof(T)>
+    {
+    public:
+        template<typename... Args>
+        static T* make(Args&&... args)
         {
-            const auto size = this->size();
-            for (L i = 0U; i < size; i += 1)
+            auto ptr = CmpsPool<T>::alloc();
+            if (ptr == nullptr)
             {
-               if (this->at(i) == comp)
-               {
-                   return i;
-               }
+                throw std::bad_alloc {};
+            }
+            try
+            {
+                return ::new (ptr) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                CmpsPool<T>::clear(ptr);
+                throw;
             }
-            return size; //TODO: analyze if something better can be done for unsigned values;
         }
 
-        template<typename R = bool>
-        //template<typename R = bool, typename... Args>
-        //auto resize(const L nSize, Args&&... args) -> std::enable_if_t<(fixedSize < 1), R>
-        auto resize(const L nSize) -> std::enable_if_t<(fixedSize < 1), R>
+        static void drop(T* const ptr)
         {
-            T* nArr = new (std::nothrow) T[nSize]; //{ T(std::forward<Args>(args)...) };
-            if (nArr == nullptr)
+            if (ptr)
             {
-                return false;
+                ptr->~T();
+                CmpsPool<T>::clear(ptr);
             }
-            const auto oSize = this->size();
-            for (L i = 0U; i < oSize && i < nSize; i += 1)
+        }
+    };
+
+    template <typename T>
+    struct CmpsPooled
+    {
+        inline static void* operator new(const std::size_t size)
+        {
+            if (size == sizeof(T))
             {
-                nArr[i] = this->at(i);
+                auto ptr = CmpsPool<T>::alloc();
+                if (ptr)
+                {
+                    return ptr;
+                }
             }
-            this->clear();
-            this->_data.setPntr(nArr);
-            this->_length = nSize;
-            return true;
+            return ::operator new(size);
+        }
+
+        inline static void operator delete(void* const ptr, const std::size_t size)
+        {
+            if (size == sizeof(T) && CmpsArena::global().contains(ptr))
+            {
+                CmpsPool<T>::clear(ptr);
+            }
+            else
+            {
+                ::operator delete(ptr);
+            }
+        }
+    };
+
+    /*
+    Unsigned integer packed in three bytes, so that it has no alignment requirement and takes exactly 24 bits inside other structures.
+    */
+    struct Pack24
+    {
+        static constexpr uint32_t MAX = 16777215U;
+
+        uint8_t bytes[3];
+
+        inline operator uint32_t() const
+        {
+            return static_cast<uint32_t>(this->bytes[0]) | (static_cast<uint32_t>(this->bytes[1]) << 8) | (static_cast<uint32_t>(this->bytes[2]) << 16);
+        }
+
+        inline Pack24& operator=(const uint32_t value)
+        {
+            this->bytes[0] = static_cast<uint8_t>(value);
+            this->bytes[1] = static_cast<uint8_t>(value >> 8);
+            this->bytes[2] = static_cast<uint8_t>(value >> 16);
+            return *this;
+        }
+    };
+
+    template <typename U>
+    constexpr uint32_t relMax()
+    {
+        if constexpr(std::is_same_v<U, Pack24>)
+        {
+            return Pack24::MAX;
+        }
+        else
+        {
+            static_assert(std::is_unsigned_v<U> && sizeof(U) < sizeof(uint32_t), "Relative pointers must be stored in 8, 16 or 24 bits.");
+            return static_cast<uint32_t>(static_cast<U>(~static_cast<U>(0U)));
+        }
+    }
+
+    /*
+    Dedicated pool of a fixed number of slots for objects of a single type, laid out contiguously in a region reserved from the arena
+    on first use, so that each object is identified by its slot number, starting from 1; free slots are linked through their first bytes
+    by their numbers, forming a lock-free stack, whose head is paired with a tag, like the batches of the block pools. The capacity only
+    bounds the slot numbers, as unless another count is set before the first use, the region is limited to a sixteenth of the arena.
+    */
+    template <typename T, const uint32_t capacity>
+    class CmpsSlots
+    {
+    protected:
+        static constexpr std::size_t SLOT_SIZE = ((sizeof(T) < sizeof(uint32_t) ? sizeof(uint32_t) : sizeof(T)) + alignof(uint32_t) - 1U)
+                                                 & ~(alignof(uint32_t) - 1U);
+
+        inline static std::atomic<uint32_t> _top = 0U;
+        inline static std::atomic<uint64_t> _free = 0U;
+        inline static std::atomic<uint32_t> _count = 0U;
+        inline static std::atomic<bool> _reserved = false;
+
+        static char* reserve()
+        {
+            auto& arena = CmpsArena::global();
+            uint32_t count = _count.load(std::memory_order_relaxed);
+            if (count == 0U)
+            {
+                const std::size_t share = arena.size() / 16U / SLOT_SIZE;
+                count = share < capacity ? (share ? static_cast<uint32_t>(share) : 1U) : capacity;
+            }
+            _count.store(count, std::memory_order_relaxed);
+            _reserved.store(true, std::memory_order_relaxed);
+            auto region = arena.allocate(SLOT_SIZE * count, alignof(T) < 16U ? 16U : alignof(T));
+            if (region == nullptr)
+            {
+                throw std::bad_alloc {};
+            }
+            return static_cast<char*>(region);
         }
 
-        inline P ptr() const
+        inline static char* base()
         {
-            return this->_data;
+            static char* const region = CmpsSlots<T, capacity>::reserve();
+            return region;
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(std::nullptr_t)
+        inline static uint32_t& link(const uint32_t idx)
         {
-            this->clear();
-            if (fixedSize < 1)
-            {
-                this->_length = 0;
-                this->_init = false;
-            }
-            this->_data = nullptr;
-            return *this;
+            return *reinterpret_cast<uint32_t*>(base() + (idx - 1U) * SLOT_SIZE);
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(const BaseVct<T, P, L, 0, true>& copy)
+    public:
+        inline static T* at(const uint32_t idx)
         {
-            //this->clear();
-            this->copy(copy);
-            return *this;
+            return reinterpret_cast<T*>(base() + (idx - 1U) * SLOT_SIZE);
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>& operator=(const BaseVct<T, P, L, fixedSize, false>& copy)
+        inline static uint32_t index(const T* const ptr)
         {
-            this->clear();
-            this->copy(copy);
-            return *this;
+            return static_cast<uint32_t>((reinterpret_cast<const char*>(ptr) - base()) / SLOT_SIZE) + 1U;
         }
 
-        inline bool operator<(const T* const ptr) const
+        inline static bool contains(const void* const ptr)
         {
-            return this->ptr().addr() < ptr;
+            auto region = base();
+            return ptr >= region && ptr < region + SLOT_SIZE * _count.load(std::memory_order_relaxed);
         }
 
-        inline bool operator>(const T* const ptr) const
+        /*
+        Sets the number of slots to reserve, up to the capacity, returning false if the region has already been reserved.
+        */
+        static bool setCount(const uint32_t count)
         {
-            return this->ptr().addr() > ptr;
+            if (_reserved.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            _count.store(count < capacity ? count : capacity, std::memory_order_relaxed);
+            return true;
         }
 
-        inline bool operator<=(const T* const ptr) const
+        inline static uint32_t count()
         {
-            return this->ptr().addr() <= ptr;
+            base();
+            return _count.load(std::memory_order_relaxed);
         }
 
-        inline bool operator>=(const T* const ptr) const
+        static void* alloc()
         {
-            return this->ptr().addr() >= ptr;
+            const uint32_t count = CmpsSlots<T, capacity>::count();
+            auto free = _free.load(std::memory_order_acquire);
+            uint32_t head;
+            do
+            {
+                head = static_cast<uint32_t>(free);
+                if (head == 0U)
+                {
+                    if (_top.load(std::memory_order_relaxed) >= count)
+                    {
+                        return nullptr;
+                    }
+                    const uint32_t top = _top.fetch_add(1U, std::memory_order_relaxed);
+                    if (top >= count)
+                    {
+                        return nullptr;
+                    }
+                    return at(top + 1U);
+                }
+            }
+            while (!_free.compare_exchange_weak(free, ((free >> 32) + 1U) << 32 | link(head),
+                                                std::memory_order_acquire, std::memory_order_acquire));
+            return at(head);
         }
 
-        inline bool operator==(const T* const ptr) const
+        static void clear(void* const ptr)
         {
-            return this->ptr().addr() == ptr;
+            const uint32_t idx = index(static_cast<T*>(ptr));
+            auto free = _free.load(std::memory_order_relaxed);
+            do
+            {
+                link(idx) = static_cast<uint32_t>(free);
+            }
+            while (!_free.compare_exchange_weak(free, ((free >> 32) + 1U) << 32 | idx,
+                                                std::memory_order_release, std::memory_order_relaxed));
         }
 
-        inline bool operator!=(const T* const ptr) const
+        template<typename... Args>
+        static T* make(Args&&... args)
         {
-            return this->ptr().addr() != ptr;
+            auto ptr = CmpsSlots<T, capacity>::alloc();
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc {};
+            }
+            try
+            {
+                return ::new (ptr) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                CmpsSlots<T, capacity>::clear(ptr);
+                throw;
+            }
         }
 
-        inline bool operator!=(const P& cloned) const
+        static void drop(T* const ptr)
         {
-            return this->ptr() != cloned.ptr();
+            if (ptr)
+            {
+                ptr->~T();
+                CmpsSlots<T, capacity>::clear(ptr);
+            }
         }
+    };
 
-        inline bool operator==(const P& cloned) const
+    /*
+    Pointer to an object of a dedicated slot pool, stored as its slot number in the unsigned type U, which can be uint8_t, uint16_t or
+    Pack24, for pools of up to 255, 65535 or 16777215 objects; as the number is relative to the pool and not to the address space, it is
+    never listed, but only pointers to objects of the pool can be stored, therefore new objects are created through the pool as well.
+    */
+    template<typename T, typename U = uint16_t, const int own = 0, const int opt = 2, typename S = CmpsSlots<T, relMax<U>()>>
+    class BaseRel : public BasePtr<T, BaseRel<T, U, own, opt, S>, opt>
+    {
+        U _ptr;
+
+    protected:
+        inline T* addr() const
         {
-            return this->ptr() == cloned.ptr();
+            const uint32_t idx = this->_ptr;
+            return idx ? S::at(idx) : nullptr;
         }
 
-        inline bool operator<=(const P& cloned) const
+        inline void setAddr(std::nullptr_t)
         {
-            return this->ptr() <= cloned.ptr();
+            this->_ptr = 0U;
         }
 
-        inline bool operator<(const P& cloned) const
+        inline void setAddr(T* const ptr)
         {
-            return this->ptr() < cloned.ptr();
+            assert(ptr == nullptr || S::contains(ptr));
+            this->_ptr = ptr ? S::index(ptr) : 0U;
         }
 
-        inline bool operator>(const P& cloned) const
+        inline void copy(const BaseRel<T, U, own, opt, S>& cloned)
         {
-            return this->ptr() > cloned.ptr();
+            static_assert(own < 1, "Attempting to clone unique pointer.");
+            this->_ptr = static_cast<uint32_t>(cloned._ptr);
+            if constexpr(own < 0)
+            {
+                const_cast<BaseRel<T, U, own, opt, S>&>(cloned)._ptr = 0U;
+            }
         }
 
-        inline bool operator>=(const P& cloned) const
+        inline void move(BaseRel<T, U, own, opt, S>&& cloned)
         {
-            return this->ptr() >= cloned.ptr();
+            this->_ptr = static_cast<uint32_t>(cloned._ptr);
+            cloned._ptr = 0U;
         }
 
-        inline bool operator!=(const BaseVct& cloned) const
+        inline void setPntr(std::nullptr_t)
         {
-            return this->ptr() != cloned.ptr();
+            static_assert(!own, "Attempting to change unique pointer.");
+            this->setAddr(static_cast<std::nullptr_t>(nullptr));
         }
 
-        inline bool operator==(const BaseVct& cloned) const
+        inline void setPntr(T* const ptr)
         {
-            return this->ptr() == cloned.ptr();
+            static_assert(!own, "Attempting to change unique pointer.");
+            this->setAddr(ptr);
         }
 
-        inline bool operator<=(const BaseVct& cloned) const
+    public:
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::BasePtr;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator*;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator->;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator();
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator bool;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator==;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator!=;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator>=;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator<=;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator>;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator<;
+        using BasePtr<T, BaseRel<T, U, own, opt, S>, opt>::operator=;
+
+        template<typename... Args>
+        inline static BaseRel<T, U, own, opt, S> make(Args&&... args)
         {
-            return this->ptr() <= cloned.ptr();
+            return BaseRel<T, U, own, opt, S>(S::make(std::forward<Args>(args)...));
         }
 
-        inline bool operator<(const BaseVct& cloned) const
+        template<typename... Args, typename R = T&>
+        inline auto refOrNew(Args&&... args) -> std::enable_if_t<(opt != 0 && opt > -2), R>
         {
-            return this->ptr() < cloned.ptr();
+            auto ptr = this->addr();
+            if (ptr == nullptr)
+            {
+                ptr = S::make(std::forward<Args>(args)...);
+                this->setAddr(ptr);
+            }
+            return *ptr;
         }
 
-        inline bool operator>(const BaseVct& cloned) const
+        inline uint32_t index() const
         {
-            return this->ptr() > cloned.ptr();
+            return this->_ptr;
         }
 
-        inline bool operator>=(const BaseVct& cloned) const
+        inline bool comrpessed() const
         {
-            return this->ptr() >= cloned.ptr();
+            return true;
         }
 
-        inline operator P() const
+        inline BaseRel<T, U, own, opt, S>()
         {
-           return this->ptr();
+            this->_ptr = 0U;
         }
 
-        inline operator bool() const
+        inline ~BaseRel()
         {
-            return const_cast<BaseVct*>(this)->_data;
+            if constexpr(own != 0)
+            {
+                S::drop(this->addr());
+            }
         }
 
-        inline T& operator[](const L index)
+        template <typename, class, const int> friend class BasePtr;
+    };
+
+    template<typename T, typename U = uint16_t, const int own = 0>
+    using CmpsRel = BaseRel<T, U, own>;
+
+    /*
+    Coroutine frames are served from size classes of 16 bytes, each one backed by its own block pool; frames larger than the biggest class,
+    or requested after the arena is exhausted, are passed on to the global operator new, thus they can still be stored, but not compressed.
+    */
+    class CmpsFrames
+    {
+    protected:
+        static constexpr std::size_t CLASS_SIZE = 16U;
+        static constexpr std::size_t CLASS_COUNT = 64U;
+
+        struct SizeClass
         {
-           return this->from(index);
+            void* (*alloc)();
+            void (*clear)(void* const);
+        };
+
+        template <std::size_t... idx>
+        static constexpr std::array<SizeClass, sizeof...(idx)> sizeClasses(std::index_sequence<idx...>)
+        {
+            return {{ { &BlockPool<(idx + 1U) * CLASS_SIZE>::alloc, &BlockPool<(idx + 1U) * CLASS_SIZE>::clear }... }};
         }
 
-        inline const T& operator[](const L index) const
+        inline static const SizeClass& classAt(const std::size_t idx)
         {
-           return this->from(index);
+            static constexpr auto classes = sizeClasses(std::make_index_sequence<CLASS_COUNT>());
+            return classes[idx];
         }
 
-        //template<L newSize = 0>
-        inline operator BaseVct<T, P, L, 0, true>() const
+    public:
+        static void* alloc(const std::size_t size)
         {
-            //static_assert(fixedSize < 1 || newSize <= fixedSize, "The compressed array passed, has fewer elements than required.");
-            //BaseVct<T, P, L, newSize, false> ret;
-            BaseVct<T, P, L, 0, true> ret;
-            ret._data = this->_data;
-            //if constexpr(newSize < 1)
+            const std::size_t sizeClass = size ? (size - 1U) / CLASS_SIZE : 0U;
+            if (sizeClass < CLASS_COUNT)
             {
-                const auto size = this->size();
-                //assert(size <= newSize);
-                ret._length = size;
-                ret._init = false;
+                auto ptr = classAt(sizeClass).alloc();
+                if (ptr)
+                {
+                    return ptr;
+                }
             }
-            return ret;
+            return ::operator new(size);
         }
 
-        /*inline BaseVct<T, P, L, fixedSize, dispose>(std::nullptr_t)
+        static void clear(void* const ptr, const std::size_t size)
         {
-            if constexpr(fixedSize < 1)
+            const std::size_t sizeClass = size ? (size - 1U) / CLASS_SIZE : 0U;
+            if (sizeClass < CLASS_COUNT && CmpsArena::global().contains(ptr))
             {
-                this->_init = false;
-                this->_length = 0;
+                classAt(sizeClass).clear(ptr);
             }
-            this->_data = P(nullptr);
-        }*/
+            else
+            {
+                ::operator delete(ptr);
+            }
+        }
+    };
 
-        inline BaseVct<T, P, L, fixedSize, dispose>(const BaseVct<T, P, L, 0, true>& copy)
+    struct CmpsPromise
+    {
+        inline static void* operator new(const std::size_t size)
         {
-            this->copy(copy);
+            return CmpsFrames::alloc(size);
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>(const BaseVct<T, P, L, fixedSize, false>& copy)
+        inline static void operator delete(void* const ptr, const std::size_t size)
         {
-            this->copy(copy);
+            CmpsFrames::clear(ptr, size);
         }
+    };
+#ifdef CMPS_COROUTINES
+    template <typename P = void>
+    class CmpsCoro
+    {
+        BaseCmp<char, 0, 2> _frame;
 
-        inline BaseVct<T, P, L, fixedSize, dispose>(const P beginPtr, const L size = fixedSize, const bool own = false)
+    public:
+        inline std::coroutine_handle<P> handle() const
         {
-            //static_assert(fixedSize < 1 || size <= fixedSize, "The size cannot be higher, than the fixed length.");
-            assert(fixedSize < 1 || size <= fixedSize);
-            this->_data = beginPtr;
-            if constexpr(fixedSize < 1)
-            {
-                this->_length = size < 0 ? size * -1 : size;
-                this->_init = own;
-            }
+            return std::coroutine_handle<P>::from_address(const_cast<char*>(this->_frame.ptr()));
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>(T* beginPtr, const L size = fixedSize, const bool own = false)
+        inline bool done() const
         {
-            //static_assert(fixedSize < 1 || size <= fixedSize, "The size cannot be higher, than the fixed length.");
-            assert(fixedSize < 1 || size <= fixedSize);
-            this->_data = beginPtr;
-            if constexpr(fixedSize < 1)
-            {
-                this->_length = size < 0 ? size * -1 : size;
-                this->_init = own;
-            }
+            return this->handle().done();
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>(std::initializer_list<T> list)
+        inline void resume() const
         {
-            //if constexpr(fixedSize < 1)
-            {
-                L i = 0U;
-                auto end = list.end();
-                auto size = list.size();
-                auto data = new (std::nothrow) T[size];
-                //auto length = sizeof(T) * size;
-                //auto data = alloc(length);
-                if (data)
-                {
-                    for (auto it = list.begin(); i < size && it != end; ++it)
-                    {
-                        (const_cast<typename std::remove_const<T>::type&>(data[i++])) = const_cast<typename std::remove_const<T>::type&>(*it);
-                    }
-                    this->_data = const_cast<typename std::remove_const<T>::type*>(data);
-                    //std::memcpy(const_cast<void*>(static_cast<const void*>(const_cast<const T*>(data))), list.begin(), length);
-                    //std::memcpy(data, list.begin(), length);
-                    //this->_data = P(static_cast<T*>(data));
-                    if constexpr(fixedSize < 1)
-                    {
-                        this->_length = size;
-                        this->_init = true;
-                    }
-                }
-                else
-                {
-                    this->_data = P(nullptr);
-                    if constexpr(fixedSize < 1)
-                    {
-                        this->_init = false;
-                        this->_length = 0U;
-                    }
-                }
-            }
-            /*else
-            {
-                //static_assert(fixedSize <= list.size(), "The initialization list passed, has fewer elements than required.");
-                assert(fixedSize <= list.size());
-                this->_data = const_cast<typename std::remove_const_t<T*>>(list.begin());
-                if constexpr(fixedSize < 1)
-                {
-                    this->_init = false;
-                    this->_length = list.size();
-                }
-            }*/
+            this->handle().resume();
         }
 
-        inline BaseVct<T, P, L, fixedSize, dispose>()
+        inline void destroy()
         {
-            this->_data = nullptr;
-            if constexpr(fixedSize < 1)
+            auto frame = this->_frame.takePtr();
+            if (frame)
             {
-                this->_init = false;
-                this->_length = 0;
+                std::coroutine_handle<P>::from_address(frame).destroy();
             }
         }
 
-        inline ~BaseVct<T, P, L, fixedSize, dispose>()
+        inline operator bool() const
         {
-            this->clear();
+            return this->_frame.hasRef();
         }
 
-        template<typename, typename, typename X, const X, const bool> friend class BaseVct;
-    };
+        inline CmpsCoro<P>(const std::coroutine_handle<P> handle)
+        {
+            this->_frame.setPtr(static_cast<char*>(handle.address()));
+        }
 
-    template<typename T = void, const int own = 0, const int opt = 2, const int level = CMPS_LEVEL>
-    using CmpsPtr = BaseCmp<T, own, opt, level>;
-    template<typename T = void, const bool weak = false, const int cow = -1, const int opt = -1, typename C = std::atomic<uint32_t>, const int level = CMPS_LEVEL>
-    using CmpsCnt = BaseCnt<T, cow, weak, opt, C, level>;
-    template<typename T, typename L = uint32_t, const L fixedSize = 0, typename P = CmpsPtr<T>, const bool dispose = fixedSize < 1>
-    using CmpsVct = BaseVct<T, P, L, fixedSize, dispose>;
+        inline CmpsCoro<P>() {}
+    };
+#endif
 
 }
 
+#ifndef CMPS_STD_ONLY
+/*
+Qt containers relocate their elements by copying their bytes, without destroying the sources, so counted references only need to avoid
+being tracked by address, which is the case of the weak ones whose targets keep track of them.
+*/
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#define CMPS_RELOCATABLE_TYPE Q_RELOCATABLE_TYPE
+#else
+#define CMPS_RELOCATABLE_TYPE Q_MOVABLE_TYPE
+#endif
+#define CMPS_COMMA ,
+template <typename T, const int own, const int opt, const int level>
+Q_DECLARE_TYPEINFO_BODY(cmpsptr::BaseCmp<T CMPS_COMMA own CMPS_COMMA opt CMPS_COMMA level>, CMPS_RELOCATABLE_TYPE);
+template <typename T, const int cow, const bool weak, const int opt, typename C, const int level>
+Q_DECLARE_TYPEINFO_BODY(cmpsptr::BaseCnt<T CMPS_COMMA cow CMPS_COMMA weak CMPS_COMMA opt CMPS_COMMA C CMPS_COMMA level>,
+                        cow == 0 && weak ? Q_COMPLEX_TYPE : CMPS_RELOCATABLE_TYPE);
+template<typename T, typename P, typename L, const L fixedSize, const bool dispose>
+Q_DECLARE_TYPEINFO_BODY(cmpsptr::BaseVct<T CMPS_COMMA P CMPS_COMMA L CMPS_COMMA fixedSize CMPS_COMMA dispose>, CMPS_RELOCATABLE_TYPE);
+#undef CMPS_COMMA
+#endif
+
 #endif // CMPSPTR_HPP
@@ -0,0 +1,341 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSROPE_HPP
+#define CMPSROPE_HPP
+
+#include "cmpsptr.hpp"
+#include <string>
+#include <string_view>
+
+namespace cmpsptr
+{
+    /*
+    Immutable rope, made of leaves holding chunks of up to LEAF_LEN characters and of inner nodes joining two subtrees, which are shared
+    by counted compressed references, so that copies of a rope are snapshots costing a single reference, while edits create new nodes
+    only along the paths they change. Concatenations merge small leaves, and trees which are deeper than MAX_DEPTH or shorter than the
+    Fibonacci number of their depth, are rebuilt from their leaves, without copying any of them.
+    */
+    class CmpsRope
+    {
+    protected:
+        static constexpr uint32_t LEAF_LEN = 512U;
+        static constexpr uint32_t MAX_DEPTH = 64U;
+
+        struct Node;
+        using Link = CmpsCnt<Node, false, -1, 2>;
+
+        struct Node
+        {
+            Link left;
+            Link right;
+            CmpsVct<char> text;
+            uint32_t length = 0U;
+            uint32_t depth = 0U;
+        };
+
+        Link _root;
+
+        inline static Node* get(const Link& link)
+        {
+            return const_cast<Link&>(link).ptr();
+        }
+
+        static bool balanced(const Node* const node)
+        {
+            uint64_t prev = 1U, fib = 1U;
+            for (uint32_t i = 0U; i < node->depth; i += 1U)
+            {
+                const uint64_t next = prev + fib;
+                prev = fib;
+                fib = next;
+            }
+            return node->length >= fib;
+        }
+
+        static Link leaf(const char* const text, const uint32_t length)
+        {
+            auto node = new Node;
+            node->text.resize(length);
+            std::memcpy(node->text.begin(), text, length);
+            node->length = length;
+            return Link(node);
+        }
+
+        static Link join(const Link& left, const Link& right)
+        {
+            auto leftNode = get(left), rightNode = get(right);
+            auto node = new Node;
+            node->left = left;
+            node->right = right;
+            node->length = leftNode->length + rightNode->length;
+            node->depth = (leftNode->depth > rightNode->depth ? leftNode->depth : rightNode->depth) + 1U;
+            return Link(node);
+        }
+
+        static Link merge(const Node* const left, const Node* const right)
+        {
+            auto node = new Node;
+            node->text.resize(left->length + right->length);
+            std::memcpy(node->text.begin(), left->text.begin(), left->length);
+            std::memcpy(node->text.begin() + left->length, right->text.begin(), right->length);
+            node->length = left->length + right->length;
+            return Link(node);
+        }
+
+        static void leaves(const Link& link, std::vector<Link>& out)
+        {
+            auto node = get(link);
+            if (node->depth == 0U)
+            {
+                out.push_back(link);
+            }
+            else
+            {
+                leaves(node->left, out);
+                leaves(node->right, out);
+            }
+        }
+
+        static Link rebuild(const std::vector<Link>& leaves, const std::size_t begin, const std::size_t end)
+        {
+            if (end - begin == 1U)
+            {
+                return leaves[begin];
+            }
+            const std::size_t middle = begin + (end - begin) / 2U;
+            return join(rebuild(leaves, begin, middle), rebuild(leaves, middle, end));
+        }
+
+        static Link build(const char* const text, const uint32_t length)
+        {
+            if (length <= LEAF_LEN)
+            {
+                return leaf(text, length);
+            }
+            const uint32_t half = ((length / LEAF_LEN + 1U) / 2U) * LEAF_LEN;
+            return join(build(text, half), build(text + half, length - half));
+        }
+
+        static Link concat(const Link& left, const Link& right)
+        {
+            auto leftNode = get(left), rightNode = get(right);
+            if (leftNode == nullptr || leftNode->length == 0U)
+            {
+                return right;
+            }
+            if (rightNode == nullptr || rightNode->length == 0U)
+            {
+                return left;
+            }
+            if (rightNode->depth == 0U)
+            {
+                if (leftNode->depth == 0U)
+                {
+                    if (leftNode->length + rightNode->length <= LEAF_LEN)
+                    {
+                        return merge(leftNode, rightNode);
+                    }
+                }
+                else
+                {
+                    auto lastNode = get(leftNode->right);
+                    if (lastNode->depth == 0U && lastNode->length + rightNode->length <= LEAF_LEN)
+                    {
+                        return join(leftNode->left, merge(lastNode, rightNode));
+                    }
+                }
+            }
+            auto joined = join(left, right);
+            auto node = get(joined);
+            if (node->depth > MAX_DEPTH || !balanced(node))
+            {
+                std::vector<Link> nodes;
+                leaves(joined, nodes);
+                return rebuild(nodes, 0U, nodes.size());
+            }
+            return joined;
+        }
+
+        static Link slice(const Link& link, const uint32_t begin, const uint32_t end)
+        {
+            auto node = get(link);
+            if (begin == 0U && end == node->length)
+            {
+                return link;
+            }
+            if (begin == end)
+            {
+                return Link();
+            }
+            if (node->depth == 0U)
+            {
+                return leaf(node->text.begin() + begin, end - begin);
+            }
+            const uint32_t leftLen = get(node->left)->length;
+            if (end <= leftLen)
+            {
+                return slice(node->left, begin, end);
+            }
+            if (begin >= leftLen)
+            {
+                return slice(node->right, begin - leftLen, end - leftLen);
+            }
+            return concat(slice(node->left, begin, leftLen), slice(node->right, 0U, end - leftLen));
+        }
+
+        template <typename F>
+        static void visit(const Node* const node, F& fn)
+        {
+            if (node->depth == 0U)
+            {
+                fn(node->text.begin(), node->length);
+            }
+            else
+            {
+                visit(get(node->left), fn);
+                visit(get(node->right), fn);
+            }
+        }
+
+        inline CmpsRope(Link&& root) : _root(std::move(root)) {}
+
+    public:
+        inline uint32_t size() const
+        {
+            auto root = get(this->_root);
+            return root ? root->length : 0U;
+        }
+
+        inline bool empty() const
+        {
+            return this->size() == 0U;
+        }
+
+        inline uint32_t depth() const
+        {
+            auto root = get(this->_root);
+            return root ? root->depth : 0U;
+        }
+
+        /*
+        Returns the character at the index, which must be lower than the size; past the end, or on an empty rope, a null character.
+        */
+        char at(uint32_t idx) const
+        {
+            assert(idx < this->size());
+            auto node = get(this->_root);
+            if (node == nullptr || idx >= node->length)
+            {
+                return '\0';
+            }
+            while (node->depth > 0U)
+            {
+                auto left = get(node->left);
+                if (idx < left->length)
+                {
+                    node = left;
+                }
+                else
+                {
+                    idx -= left->length;
+                    node = get(node->right);
+                }
+            }
+            return node->text.at(idx);
+        }
+
+        inline CmpsRope concat(const CmpsRope& other) const
+        {
+            return CmpsRope(concat(this->_root, other._root));
+        }
+
+        inline CmpsRope operator+(const CmpsRope& other) const
+        {
+            return this->concat(other);
+        }
+
+        CmpsRope substr(const uint32_t pos, uint32_t length = UINT32_MAX) const
+        {
+            const uint32_t size = this->size();
+            if (pos >= size)
+            {
+                return CmpsRope();
+            }
+            if (length > size - pos)
+            {
+                length = size - pos;
+            }
+            return CmpsRope(slice(this->_root, pos, pos + length));
+        }
+
+        CmpsRope insert(const uint32_t pos, const CmpsRope& other) const
+        {
+            return this->substr(0U, pos).concat(other).concat(this->substr(pos));
+        }
+
+        inline CmpsRope insert(const uint32_t pos, const std::string_view text) const
+        {
+            return this->insert(pos, CmpsRope(text));
+        }
+
+        CmpsRope erase(const uint32_t pos, uint32_t length) const
+        {
+            const uint32_t size = this->size();
+            if (pos >= size)
+            {
+                return *this;
+            }
+            if (length > size - pos)
+            {
+                length = size - pos;
+            }
+            return this->substr(0U, pos).concat(this->substr(pos + length));
+        }
+
+        inline CmpsRope append(const std::string_view text) const
+        {
+            return this->concat(CmpsRope(text));
+        }
+
+        /*
+        Calls fn(chunk, length) for every leaf, in order.
+        */
+        template <typename F>
+        inline void forEachChunk(F fn) const
+        {
+            auto root = get(this->_root);
+            if (root)
+            {
+                visit(root, fn);
+            }
+        }
+
+        std::string toString() const
+        {
+            std::string text;
+            text.reserve(this->size());
+            this->forEachChunk([&text](const char* const chunk, const uint32_t length)
+            {
+                text.append(chunk, length);
+            });
+            return text;
+        }
+
+        inline CmpsRope(const std::string_view text)
+        {
+            if (!text.empty())
+            {
+                this->_root = build(text.data(), static_cast<uint32_t>(text.size()));
+            }
+        }
+
+        inline CmpsRope() {}
+    };
+}
+
+#endif // CMPSROPE_HPP
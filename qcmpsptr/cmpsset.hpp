@@ -0,0 +1,381 @@
+/*
+Copyright (C) AD 2022 Claudiu-Stefan Costea
+
+This Source Code Form is subject to the terms of the Mozilla Public
+License, v. 2.0. If a copy of the MPL was not distributed with this
+file, You can obtain one at https://mozilla.org/MPL/2.0/.
+*/
+#ifndef CMPSSET_HPP
+#define CMPSSET_HPP
+
+#include "cmpsptr.hpp"
+#include <iterator>
+
+namespace cmpsptr
+{
+    /*
+    Immutable sorted set of pointers, storing their compressed values in blocks of 128, as differences from the value found four positions
+    earlier, bit-packed with the width of the largest difference of the block in four interleaved lanes, so that a whole block is decoded
+    by 32 rounds of vector shifts, masks and additions, without any dependency between the lanes; each block header keeps its first and
+    last values, allowing intersections to skip the blocks which cannot match without decoding them. Pointers which cannot be compressed
+    are kept aside, sorted, in a plain vector.
+    */
+    template <typename T>
+    class CmpsPtrSet
+    {
+    protected:
+        static constexpr uint32_t BLOCK_LEN = 128U;
+        static constexpr uint32_t ROWS = BLOCK_LEN / 4U;
+
+        struct Block
+        {
+            uint32_t first;
+            uint32_t last;
+            uint32_t offset;
+            uint32_t bits;
+        };
+
+        std::vector<Block> _blocks;
+        std::vector<uint32_t> _words;
+        std::vector<T*> _listed;
+        std::size_t _count = 0U;
+
+        inline static bool compress(const T* const ptr, uint32_t& value)
+        {
+            constexpr int shift = CmpsPtr<T>::shiftLen();
+            const uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+            if (addr && addr < CmpsPtr<T>::maxAddr() && (addr & ((static_cast<uintptr_t>(1U) << shift) - 1U)) == 0U && (addr >> shift) <= 4294967295UL)
+            {
+                value = static_cast<uint32_t>(addr >> shift);
+                return true;
+            }
+            return false;
+        }
+
+        inline static T* expand(const uint32_t value)
+        {
+            return reinterpret_cast<T*>(static_cast<uintptr_t>(value) << CmpsPtr<T>::shiftLen());
+        }
+
+        inline uint32_t blockLen(const std::size_t block) const
+        {
+            const std::size_t left = this->_count - block * BLOCK_LEN;
+            return left < BLOCK_LEN ? static_cast<uint32_t>(left) : BLOCK_LEN;
+        }
+
+        void pack(const uint32_t* const values, const uint32_t count)
+        {
+            uint32_t deltas[BLOCK_LEN];
+            const uint32_t first = values[0];
+            const uint32_t last = values[count - 1U];
+            uint32_t bits = 0U, mask = 0U;
+            for (uint32_t i = 0U; i < BLOCK_LEN; i += 1U)
+            {
+                const uint32_t value = i < count ? values[i] : last;
+                const uint32_t prev = i < 4U ? first : (i - 4U < count ? values[i - 4U] : last);
+                mask |= (deltas[i] = value - prev);
+            }
+            while (bits < 32U && (mask >> bits))
+            {
+                bits += 1U;
+            }
+            const std::size_t offset = this->_words.size();
+            this->_blocks.push_back({ first, last, static_cast<uint32_t>(offset), bits });
+            if (bits)
+            {
+                this->_words.resize(offset + bits * 4U, 0U);
+                auto words = this->_words.data() + offset;
+                for (uint32_t i = 0U; i < BLOCK_LEN; i += 1U)
+                {
+                    const uint32_t pos = (i >> 2) * bits;
+                    const uint32_t word = pos >> 5, shift = pos & 31U, lane = i & 3U;
+                    words[(word << 2) + lane] |= deltas[i] << shift;
+                    if (shift + bits > 32U)
+                    {
+                        words[((word + 1U) << 2) + lane] |= deltas[i] >> (32U - shift);
+                    }
+                }
+            }
+        }
+
+        void unpack(const std::size_t idx, uint32_t* const out) const
+        {
+            auto& block = this->_blocks[idx];
+            const uint32_t bits = block.bits;
+            auto words = this->_words.data() + block.offset;
+    #ifdef CMPS_X86_SIMD
+            auto prev = _mm_set1_epi32(static_cast<int>(block.first));
+            const auto mask = _mm_set1_epi32(bits < 32U ? static_cast<int>((1U << bits) - 1U) : -1);
+            for (uint32_t row = 0U; row < ROWS; row += 1U)
+            {
+                if (bits)
+                {
+                    const uint32_t pos = row * bits;
+                    const uint32_t word = pos >> 5, shift = pos & 31U;
+                    auto delta = _mm_srl_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + (word << 2))), _mm_cvtsi32_si128(static_cast<int>(shift)));
+                    if (shift + bits > 32U)
+                    {
+                        delta = _mm_or_si128(delta, _mm_sll_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(words + ((word + 1U) << 2))),
+                                                                  _mm_cvtsi32_si128(static_cast<int>(32U - shift))));
+                    }
+                    prev = _mm_add_epi32(prev, _mm_and_si128(delta, mask));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (row << 2)), prev);
+            }
+    #else
+            const uint32_t mask = bits < 32U ? (1U << bits) - 1U : 4294967295U;
+            uint32_t prev[4] = { block.first, block.first, block.first, block.first };
+            for (uint32_t row = 0U; row < ROWS; row += 1U)
+            {
+                const uint32_t pos = row * bits;
+                const uint32_t word = pos >> 5, shift = pos & 31U;
+                for (uint32_t lane = 0U; lane < 4U; lane += 1U)
+                {
+                    if (bits)
+                    {
+                        uint32_t delta = words[(word << 2) + lane] >> shift;
+                        if (shift + bits > 32U)
+                        {
+                            delta |= words[((word + 1U) << 2) + lane] << (32U - shift);
+                        }
+                        prev[lane] += delta & mask;
+                    }
+                    out[(row << 2) + lane] = prev[lane];
+                }
+            }
+    #endif
+        }
+
+        /*
+        Walks the compressed values in order, decoding one block at a time; seek() skips the blocks ending before the requested value.
+        */
+        class Cursor
+        {
+            const CmpsPtrSet<T>* _set;
+            std::size_t _block = 0U;
+            uint32_t _pos = 0U;
+            uint32_t _len = 0U;
+            uint32_t _values[BLOCK_LEN];
+
+            inline void load(const std::size_t block)
+            {
+                this->_block = block;
+                this->_pos = 0U;
+                if (block < this->_set->_blocks.size())
+                {
+                    this->_len = this->_set->blockLen(block);
+                    this->_set->unpack(block, this->_values);
+                }
+                else
+                {
+                    this->_len = 0U;
+                }
+            }
+
+        public:
+            inline bool valid() const
+            {
+                return this->_pos < this->_len;
+            }
+
+            inline uint32_t value() const
+            {
+                return this->_values[this->_pos];
+            }
+
+            inline void next()
+            {
+                if ((this->_pos += 1U) == this->_len)
+                {
+                    this->load(this->_block + 1U);
+                }
+            }
+
+            void seek(const uint32_t value)
+            {
+                auto& blocks = this->_set->_blocks;
+                std::size_t block = this->_block;
+                if (blocks[block].last < value)
+                {
+                    while (++block < blocks.size() && blocks[block].last < value);
+                    this->load(block);
+                    if (!this->valid())
+                    {
+                        return;
+                    }
+                }
+                this->_pos = static_cast<uint32_t>(std::lower_bound(this->_values + this->_pos, this->_values + this->_len, value) - this->_values);
+            }
+
+            inline Cursor(const CmpsPtrSet<T>& set) : _set(&set)
+            {
+                this->load(0U);
+            }
+        };
+
+        void build(std::vector<uint32_t>& values, std::vector<T*>&& listed)
+        {
+            std::sort(values.begin(), values.end());
+            values.erase(std::unique(values.begin(), values.end()), values.end());
+            this->_count = values.size();
+            this->_blocks.reserve((this->_count + BLOCK_LEN - 1U) / BLOCK_LEN);
+            for (std::size_t i = 0U; i < this->_count; i += BLOCK_LEN)
+            {
+                const std::size_t left = this->_count - i;
+                this->pack(values.data() + i, left < BLOCK_LEN ? static_cast<uint32_t>(left) : BLOCK_LEN);
+            }
+            std::sort(listed.begin(), listed.end());
+            listed.erase(std::unique(listed.begin(), listed.end()), listed.end());
+            this->_listed = std::move(listed);
+        }
+
+        inline CmpsPtrSet<T>(std::vector<uint32_t>& values, std::vector<T*>&& listed)
+        {
+            this->build(values, std::move(listed));
+        }
+
+    public:
+        inline std::size_t size() const
+        {
+            return this->_count + this->_listed.size();
+        }
+
+        /*
+        Memory used by the encoded set, excluding the object itself.
+        */
+        inline std::size_t bytes() const
+        {
+            return this->_blocks.size() * sizeof(Block) + this->_words.size() * sizeof(uint32_t) + this->_listed.size() * sizeof(T*);
+        }
+
+        bool contains(const T* const ptr) const
+        {
+            uint32_t value;
+            if (ptr == nullptr)
+            {
+                return false;
+            }
+            if (!compress(ptr, value))
+            {
+                return std::binary_search(this->_listed.begin(), this->_listed.end(), ptr);
+            }
+            auto blocks = this->_blocks.data();
+            auto block = std::upper_bound(blocks, blocks + this->_blocks.size(), value, [](const uint32_t value, const Block& block)
+            {
+                return value < block.first;
+            });
+            if (block == blocks || (--block)->last < value)
+            {
+                return false;
+            }
+            uint32_t values[BLOCK_LEN];
+            const std::size_t idx = block - blocks;
+            this->unpack(idx, values);
+            return std::binary_search(values, values + this->blockLen(idx), value);
+        }
+
+        /*
+        Calls fn(ptr) for every element, the compressed ones first, in the order of their addresses, followed by the listed ones.
+        */
+        template <typename F>
+        void forEach(F fn) const
+        {
+            uint32_t values[BLOCK_LEN];
+            for (std::size_t idx = 0U; idx < this->_blocks.size(); idx += 1U)
+            {
+                this->unpack(idx, values);
+                const uint32_t len = this->blockLen(idx);
+                for (uint32_t i = 0U; i < len; i += 1U)
+                {
+                    fn(expand(values[i]));
+                }
+            }
+            for (auto ptr : this->_listed)
+            {
+                fn(ptr);
+            }
+        }
+
+        static CmpsPtrSet<T> intersect(const CmpsPtrSet<T>& first, const CmpsPtrSet<T>& second)
+        {
+            std::vector<uint32_t> values;
+            Cursor firstCursor(first), secondCursor(second);
+            while (firstCursor.valid() && secondCursor.valid())
+            {
+                const uint32_t firstValue = firstCursor.value();
+                const uint32_t secondValue = secondCursor.value();
+                if (firstValue == secondValue)
+                {
+                    values.push_back(firstValue);
+                    firstCursor.next();
+                    secondCursor.next();
+                }
+                else if (firstValue < secondValue)
+                {
+                    firstCursor.seek(secondValue);
+                }
+                else
+                {
+                    secondCursor.seek(firstValue);
+                }
+            }
+            std::vector<T*> listed;
+            std::set_intersection(first._listed.begin(), first._listed.end(), second._listed.begin(), second._listed.end(), std::back_inserter(listed));
+            return CmpsPtrSet<T>(values, std::move(listed));
+        }
+
+        static CmpsPtrSet<T> unite(const CmpsPtrSet<T>& first, const CmpsPtrSet<T>& second)
+        {
+            std::vector<uint32_t> values;
+            values.reserve(first._count + second._count);
+            Cursor firstCursor(first), secondCursor(second);
+            while (firstCursor.valid() || secondCursor.valid())
+            {
+                if (!secondCursor.valid() || (firstCursor.valid() && firstCursor.value() < secondCursor.value()))
+                {
+                    values.push_back(firstCursor.value());
+                    firstCursor.next();
+                }
+                else
+                {
+                    if (firstCursor.valid() && firstCursor.value() == secondCursor.value())
+                    {
+                        firstCursor.next();
+                    }
+                    values.push_back(secondCursor.value());
+                    secondCursor.next();
+                }
+            }
+            std::vector<T*> listed;
+            std::set_union(first._listed.begin(), first._listed.end(), second._listed.begin(), second._listed.end(), std::back_inserter(listed));
+            return CmpsPtrSet<T>(values, std::move(listed));
+        }
+
+        template <typename I>
+        CmpsPtrSet<T>(I begin, const I end)
+        {
+            std::vector<uint32_t> values;
+            std::vector<T*> listed;
+            for (; begin != end; ++begin)
+            {
+                T* const ptr = *begin;
+                uint32_t value;
+                if (compress(ptr, value))
+                {
+                    values.push_back(value);
+                }
+                else if (ptr)
+                {
+                    listed.push_back(ptr);
+                }
+            }
+            this->build(values, std::move(listed));
+        }
+
+        inline CmpsPtrSet<T>(const std::vector<T*>& ptrs) : CmpsPtrSet<T>(ptrs.begin(), ptrs.end()) {}
+
+        inline CmpsPtrSet<T>() {}
+    };
+}
+
+#endif // CMPSSET_HPP
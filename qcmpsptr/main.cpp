@@ -57,13 +57,13 @@ public:
     }
 };
 
-void testFunc2(CmpsCnt<ThirdTest> thirdTest)
+void testFunc2(CmpsBorrow<ThirdTest> thirdTest)
 {
     qDebug() << "sizeof(thirdTest) = " << sizeof(thirdTest);
     qDebug() << "thirdTestPtr->c = " << thirdTest->c;
 }
 
-void testFunc(CmpsCnt<ThirdTest> thirdTest)
+void testFunc(CmpsBorrow<ThirdTest> thirdTest)
 {
     qDebug() << "sizeof(secondTestPtr) = " << sizeof(thirdTest->secondTestPtr);
     qDebug() << "firstTestPtr->a = " << thirdTest->secondTestPtr->firstTestPtr->a;
@@ -71,10 +71,21 @@ void testFunc(CmpsCnt<ThirdTest> thirdTest)
     testFunc2(thirdTest);
 }
 
+void testMove()
+{
+    CmpsPtr<FirstTest, 1> firstTestPtr(new FirstTest);
+    CmpsPtr<FirstTest, 1> otherTestPtr(new FirstTest);
+    firstTestPtr = std::move(otherTestPtr);
+    assert(!otherTestPtr);
+    qDebug() << "moved-from otherTestPtr is null = " << !otherTestPtr;
+    qDebug() << "firstTestPtr->a = " << firstTestPtr->a;
+}
+
 int main(int argc, char *argv[])
 {
     //QCoreApplication a(argc, argv);
     CmpsCnt<ThirdTest> thirdTest(new ThirdTest);
     testFunc(thirdTest);
+    testMove();
     //return a.exec();
 }